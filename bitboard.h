@@ -0,0 +1,117 @@
+#pragma once
+
+//A fixed size set of bits with one bit per cell of the flattened board.
+//Big enough for the largest board: size 10 has a diameter of 19, so 19*19 = 361 bits in 6 words.
+//Bits past the end of the board are garbage after a ~ or a shift, so mask with the board's onboard mask.
+
+#include <stdint.h>
+
+class BitBoard {
+public:
+	static const int words = 6;
+	static const int maxbits = words*64;
+
+	uint64_t bits[words];
+
+	BitBoard() { clear(); }
+
+	void clear(){
+		for(int i = 0; i < words; i++)
+			bits[i] = 0;
+	}
+
+	void set(int i)        { bits[i >> 6] |=  (1ULL << (i & 63)); }
+	void unset(int i)      { bits[i >> 6] &= ~(1ULL << (i & 63)); }
+	bool test(int i) const { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+	bool empty() const {
+		uint64_t a = 0;
+		for(int i = 0; i < words; i++)
+			a |= bits[i];
+		return (a == 0);
+	}
+
+	int count() const {
+		int n = 0;
+		for(int i = 0; i < words; i++)
+			n += __builtin_popcountll(bits[i]);
+		return n;
+	}
+
+	//how many bits are set at or below i
+	int count_to(int i) const {
+		int n = 0, w = i >> 6;
+		for(int j = 0; j < w; j++)
+			n += __builtin_popcountll(bits[j]);
+		return n + __builtin_popcountll(bits[w] & (~0ULL >> (63 - (i & 63))));
+	}
+
+	//index of the lowest set bit, or -1 if none are set
+	int first() const { return next(-1); }
+
+	//index of the lowest set bit above i, or -1 if there are none
+	//iterate with: for(int i = b.first(); i >= 0; i = b.next(i))
+	int next(int i) const {
+		i++;
+		int w = i >> 6;
+		if(w >= words)
+			return -1;
+
+		uint64_t b = bits[w] & (~0ULL << (i & 63));
+		while(!b){
+			if(++w >= words)
+				return -1;
+			b = bits[w];
+		}
+		return (w << 6) + __builtin_ctzll(b);
+	}
+
+	//index of the highest set bit, or -1 if none are set
+	int last() const {
+		for(int w = words-1; w >= 0; w--)
+			if(bits[w])
+				return (w << 6) + 63 - __builtin_clzll(bits[w]);
+		return -1;
+	}
+
+	//shift towards higher indexes for positive n, lower indexes for negative n, |n| < 64
+	BitBoard shift(int n) const {
+		BitBoard r;
+		if(n > 0){
+			for(int i = words-1; i > 0; i--)
+				r.bits[i] = (bits[i] << n) | (bits[i-1] >> (64 - n));
+			r.bits[0] = bits[0] << n;
+		}else if(n < 0){
+			n = -n;
+			for(int i = 0; i < words-1; i++)
+				r.bits[i] = (bits[i] >> n) | (bits[i+1] << (64 - n));
+			r.bits[words-1] = bits[words-1] >> n;
+		}else{
+			r = *this;
+		}
+		return r;
+	}
+
+	BitBoard operator ~ () const {
+		BitBoard r;
+		for(int i = 0; i < words; i++)
+			r.bits[i] = ~bits[i];
+		return r;
+	}
+
+	BitBoard & operator &= (const BitBoard & o){ for(int i = 0; i < words; i++) bits[i] &= o.bits[i]; return *this; }
+	BitBoard & operator |= (const BitBoard & o){ for(int i = 0; i < words; i++) bits[i] |= o.bits[i]; return *this; }
+	BitBoard & operator ^= (const BitBoard & o){ for(int i = 0; i < words; i++) bits[i] ^= o.bits[i]; return *this; }
+
+	BitBoard operator & (const BitBoard & o) const { BitBoard r = *this; return r &= o; }
+	BitBoard operator | (const BitBoard & o) const { BitBoard r = *this; return r |= o; }
+	BitBoard operator ^ (const BitBoard & o) const { BitBoard r = *this; return r ^= o; }
+
+	bool operator == (const BitBoard & o) const {
+		for(int i = 0; i < words; i++)
+			if(bits[i] != o.bits[i])
+				return false;
+		return true;
+	}
+	bool operator != (const BitBoard & o) const { return !(*this == o); }
+};
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <cstdio>
+#include <cstring>
 #include <algorithm>
 #include <vector>
 #include <string>
@@ -11,7 +12,7 @@ using namespace std;
 #include "move.h"
 #include "string.h"
 #include "zobrist.h"
-#include "hashset.h"
+#include "bitboard.h"
 
 static const int BitsSetTable64[] = {
 	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
@@ -44,9 +45,30 @@ const MoveScore neighbours[18] = {
 
 static MoveValid * staticneighbourlist[11] = {NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL}; //one per boardsize
 
+//the shape of a board of one size, built once per size so the geometry in the hot paths is a lookup instead of arithmetic
+struct BoardTables {
+	BitBoard onboard;  //which cells are on the board
+	BitBoard nbsrc[6]; //which cells have an onboard neighbour in direction i
+	int      nbshift[6]; //how far to shift a cell to reach its neighbour in direction i
+
+	Move   xymove[BitBoard::maxbits]; //x,y of each flattened index, avoids a divide
+	int8_t corner[BitBoard::maxbits]; //which corner each cell is, -1 for none or offboard
+	int8_t edge[BitBoard::maxbits];   //which edge each cell is, -1 for none or offboard
+	int8_t linestart[19], lineend[19]; //first and one past the last x of each row, 19 is the diameter of the largest board
+	uint16_t symmetry[12][BitBoard::maxbits]; //where each cell goes under the 6 rotations and 6 mirrors, same order as the hashes
+	hash_t   zobrist[BitBoard::maxbits][2][12]; //the 12 zobrist keys of a stone of each player on each cell, for the symmetric hashes
+	uint32_t pattern[BitBoard::maxbits]; //the pattern of each cell on an empty board, just the offboard neighbours, see Board::patterns
+	uint32_t patternbits[3][6]; //added to a cell's pattern by a stone of each player in direction i from the cell
+};
+
+static BoardTables * statictables[11] = {NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL}; //one per boardsize
+
 
 class Board{
 public:
+	static const int maxsize = 10;
+	static const int maxvecsize = (maxsize*2-1)*(maxsize*2-1); //cells in the flattened array of the largest board
+
 	struct Cell {
 /*
 		unsigned piece  : 2; //who controls this cell, 0 for none, 1,2 for players
@@ -66,7 +88,7 @@ mutable uint16_t parent; //parent for this group of cells
 mutable uint8_t ringdepth; //when doing a ring search, what depth was this position found
 //*/
 
-		Cell() : piece(0), size(0), parent(0), corner(0), edge(0), perm(0), local(0), ringdepth(0) { }
+		Cell() { } //left uninitialized, so the inline array in Board costs nothing to construct
 		Cell(unsigned int p, unsigned int a, unsigned int s, unsigned int c, unsigned int e, unsigned int l) :
 			piece(p), size(s), parent(a), corner(c), edge(e), perm(0), local(l), ringdepth(0) { }
 
@@ -76,19 +98,15 @@ mutable uint8_t ringdepth; //when doing a ring search, what depth was this posit
 
 	class MoveIterator { //only returns valid moves...
 		const Board & board;
-		int lineend;
+		BitBoard empties; //empty cells, iterated in xy order
+		int pos; //xy of the current move, -1 before the first cell
 		Move move;
-		bool unique;
-		HashSet hashes;
+		unsigned int syms; //symmetries of the position if only unique moves are wanted, see Board::symmetries
 	public:
-		MoveIterator(const Board & b, bool Unique, bool allowswap) : board(b), lineend(0), move(Move(M_SWAP)), unique(Unique) {
+		MoveIterator(const Board & b, bool unique, bool allowswap) : board(b), empties(b.emptymask()), pos(-1), move(Move(M_SWAP)), syms(unique ? b.symmetries() : 0) {
 			if(board.outcome >= 0){
 				move = Move(0, board.size_d); //already done
 			}else if(!allowswap || !board.valid_move(move)){ //check if swap is valid
-				if(unique){
-					hashes.init(board.movesremain());
-					hashes.add(board.test_hash(move, board.toplay()));
-				}
 				++(*this); //find the first valid move
 			}
 		}
@@ -100,26 +118,17 @@ mutable uint8_t ringdepth; //when doing a ring search, what depth was this posit
 		bool operator != (const Board::MoveIterator & rhs) const { return (move != rhs.move); }
 		MoveIterator & operator ++ (){ //prefix form
 			while(true){
-				do{
-					move.x++;
+				pos = empties.next(pos);
 
-					if(move.x >= lineend){
-						move.y++;
-						if(move.y >= board.get_size_d()) //done
-							return *this;
+				if(pos < 0){ //done
+					move = Move(0, board.size_d);
+					return *this;
+				}
 
-						move.x = board.linestart(move.y);
-						lineend = board.lineend(move.y);
-					}
-				}while(!board.valid_move_fast(move));
+				if(syms && !board.canonical(pos, syms))
+					continue;
 
-				if(unique){
-					uint64_t h = board.test_hash(move, board.toplay());
-					if(hashes.exists(h))
-						continue;
-					else
-						hashes.add(board.test_hash(move, board.toplay()));
-				}
+				move = board.xymove(pos);
 				break;
 			}
 
@@ -132,12 +141,58 @@ mutable uint8_t ringdepth; //when doing a ring search, what depth was this posit
 		}
 	};
 
+	//records everything move() changes so undo() can restore the board exactly
+	//owned by the caller and attached with set_journal, so copying a board stays a memcpy
+	class Journal {
+		friend class Board;
+
+		struct Change {
+			uint16_t xy;
+			Cell cell;
+		};
+		struct Frame {
+			unsigned int changes; //number of cell changes before this move
+			Move last;
+			short nummoves;
+			char toPlay;
+			char outcome;
+			char wintype;
+			short movexy; //-1 for swap
+		};
+
+		//the vectors only grow, so recording a move never constructs or frees anything once warmed up
+		vector<Change> changes;
+		vector<Frame> frames;
+		unsigned int numchanges, numframes;
+
+		void addchange(int xy, const Cell & c){
+			if(numchanges == changes.size())
+				changes.resize(numchanges*2 + 64);
+			changes[numchanges].xy = xy;
+			changes[numchanges].cell = c;
+			numchanges++;
+		}
+		Frame & addframe(){
+			if(numframes == frames.size())
+				frames.resize(numframes*2 + 16);
+			return frames[numframes++];
+		}
+	public:
+		Journal() : numchanges(0), numframes(0) { }
+		void clear(){
+			numchanges = 0;
+			numframes = 0;
+		}
+		int depth() const { return numframes; }
+	};
+
 private:
 	char size; //the length of one side of the hexagon
 	char sizem1; //size - 1
 	char size_d; //diameter of the board = size*2-1
 
 	short num_cells;
+	short num_empty; //length of emptylist
 	short nummoves;
 	short unique_depth; //update and test rotations/symmetry with less than this many pieces on the board
 	Move last;
@@ -146,13 +201,31 @@ private:
 	char wintype; //0 no win, 1 = edge, 2 = corner, 3 = ring
 	bool allowswap;
 
-	vector<Cell> cells;
+	BitBoard stones[2]; //which cells each player has a stone on
+	bool trackwins;  //keep wincells and ringcells up to date on every move, see track_wins
+	bool trackrings; //ringcells too, or leave it empty when rings don't matter
+	BitBoard wincells[2];  //empty cells where each player wins by connecting corners or edges
+	BitBoard ringcells[2]; //empty cells where each player wins only by a ring
 	Zobrist hash;
 	const MoveValid * neighbourlist;
+	const BoardTables * tables;
+	Journal * journal; //NULL unless moves are being recorded for undo
+
+	//inline so copies never touch the heap, these must stay last and in this order, see copy()
+	Cell cells[maxvecsize];
+	uint32_t patterns[maxvecsize];  //the 12 bit pattern of each cell's neighbours, see pattern(), with the colours inverted in the top 16 bits
+	uint16_t emptypos[maxvecsize];  //index into emptylist of each empty cell, left stale once filled so undo can put it back
+	uint16_t emptylist[maxvecsize]; //dense list of the empty cells, in no particular order
 
 public:
 	Board(){
 		size = 0;
+		sizem1 = 0;
+		size_d = 0;
+		num_empty = 0;
+		journal = NULL;
+		trackwins = false;
+		trackrings = false;
 	}
 
 	Board(int s){
@@ -166,34 +239,98 @@ public:
 		outcome = -3;
 		wintype = 0;
 		allowswap = false;
+		trackwins = false;
+		trackrings = false;
 		neighbourlist = get_neighbour_list();
+		tables = get_tables();
+		journal = NULL;
 		num_cells = vecsize() - size*sizem1;
-
-		cells.resize(vecsize());
+		num_empty = 0;
 
 		for(int y = 0; y < size_d; y++){
 			for(int x = 0; x < size_d; x++){
 				int i = xy(x, y);
 				cells[i] = Cell(0, i, 1, (1 << iscorner(x, y)), (1 << isedge(x, y)), 0);
+				emptypos[i] = num_empty;
+				if(onboard(x, y))
+					emptylist[num_empty++] = i;
 			}
 		}
+		memcpy(patterns, tables->pattern, sizeof(uint32_t)*vecsize());
+	}
+
+	Board(const Board & o){
+		copy(o);
+	}
+
+	Board & operator = (const Board & o){
+		if(this != &o)
+			copy(o);
+		return *this;
 	}
 
-	int memsize() const { return sizeof(Board) + sizeof(Cell)*vecsize(); }
+	//copy the header and only the parts of the arrays in use, skipping the tails that only bigger boards need
+	void copy(const Board & o){
+		memcpy((void*)this, (const void*)&o, (const char*)(o.cells + o.vecsize()) - (const char*)&o);
+		memcpy(patterns, o.patterns, sizeof(uint32_t)*o.vecsize());
+		memcpy(emptypos, o.emptypos, sizeof(uint16_t)*o.vecsize());
+		memcpy(emptylist, o.emptylist, sizeof(uint16_t)*o.num_empty);
+		journal = NULL; //a copy starts its own history
+	}
+
+	int memsize() const { return (const char*)(cells + vecsize()) - (const char*)this + sizeof(uint32_t)*vecsize() + sizeof(uint16_t)*(vecsize() + num_empty); }
 
 	int get_size_d() const { return size_d; }
 	int get_size() const{ return size; }
 
 	int vecsize() const { return size_d*size_d; }
 	int numcells() const { return num_cells; }
+	int numempty() const { return num_empty; }
+
+	//the empty cells in no particular order, so a uniform random move is emptymove(rand() % numempty())
+	int  emptyxy(int i)   const { return emptylist[i]; }
+	Move emptymove(int i) const { return xymove(emptylist[i]); }
+
+	//bit k is set if symmetry k maps every stone onto a stone of the same colour, identity excluded
+	//only the stones are compared, so this is exact rather than relying on the hashes
+	unsigned int symmetries() const {
+		unsigned int syms = 0;
+		for(int k = 1; k < 12; k++){
+			const uint16_t * sym = tables->symmetry[k];
+			bool same = true;
+			for(int p = 0; p < 2 && same; p++)
+				for(int i = stones[p].first(); i >= 0 && same; i = stones[p].next(i))
+					same = (cells[sym[i]].piece == p+1);
+			if(same)
+				syms |= (1 << k);
+		}
+		return syms;
+	}
+
+	//is cell i the lowest index in its orbit under the symmetries in syms, so exactly one move of each orbit passes
+	bool canonical(int i, unsigned int syms) const {
+		for(int k = 1; k < 12; k++)
+			if(((syms >> k) & 1) && tables->symmetry[k][i] < i)
+				return false;
+		return true;
+	}
 
 	int num_moves() const { return nummoves; }
+
+	//how deep the symmetric hashes and unique moves go, only changeable on an empty board since deeper moves only update the first hash
+	int get_unique_depth() const { return unique_depth; }
+	void set_unique_depth(int d){
+		assert(nummoves == 0);
+		unique_depth = d;
+	}
 	int movesremain() const { return (won() >= 0 ? 0 : num_cells - nummoves + canswap()); }
 
 	int xy(int x, int y)   const { return   y*size_d +   x; }
 	int xy(const Move & m) const { return m.y*size_d + m.x; }
 	int xy(const MoveValid & m) const { return m.xy; }
 
+	Move xymove(int i) const { return tables->xymove[i]; }
+
 	int xyc(int x, int y)   const { return xy(  x + sizem1,   y + sizem1); }
 	int xyc(const Move & m) const { return xy(m.x + sizem1, m.y + sizem1); }
 
@@ -211,6 +348,19 @@ public:
 
 	int geton(const MoveValid & m) const { return (m.onboard() ? get(m.xy) : 0); }
 
+	//bitboards with one bit per cell, indexed by xy()
+	const BitBoard & onboardmask()          const { return tables->onboard; }
+	const BitBoard & stonemask(int player)  const { return stones[player-1]; }
+	BitBoard emptymask() const { return tables->onboard & ~(stones[0] | stones[1]); }
+
+	//all the onboard cells that neighbour a cell in b, computed a word at a time
+	BitBoard nbmask(const BitBoard & b) const {
+		BitBoard r;
+		for(int i = 0; i < 6; i++)
+			r |= (b & tables->nbsrc[i]).shift(tables->nbshift[i]);
+		return r;
+	}
+
 	int local(const Move & m, char turn) const { return local(xy(m), turn); }
 	int local(int i,          char turn) const {
 		char localshift = (turn & 2); //0 for p1, 2 for p2
@@ -247,7 +397,11 @@ public:
 	const MoveValid * nb_end(const MoveValid * m) const { return m + 6; }
 	const MoveValid * nb_endhood(const MoveValid * m) const { return m + 18; }
 
-	int iscorner(int x, int y) const {
+	int iscorner(int x, int y) const { return (onboard(x, y) ? tables->corner[xy(x, y)] : -1); }
+	int isedge(int x, int y)   const { return (onboard(x, y) ? tables->edge[xy(x, y)]   : -1); }
+
+private:
+	int calc_corner(int x, int y) const {
 		if(!onboard(x,y))
 			return -1;
 
@@ -263,7 +417,7 @@ public:
 		return -1;
 	}
 
-	int isedge(int x, int y) const {
+	int calc_edge(int x, int y) const {
 		if(!onboard(x,y))
 			return -1;
 
@@ -301,9 +455,69 @@ public:
 		return staticneighbourlist[(int)size];
 	}
 
+	BoardTables * get_tables(){
+		if(!statictables[(int)size]){
+			BoardTables * m = new BoardTables();
+
+			for(int i = 0; i < 6; i++)
+				m->nbshift[i] = neighbours[i].y*size_d + neighbours[i].x;
+
+			//neighbour i is in bits 10-11 of the pattern down to 0-1 for neighbour 5, so a stone in direction i from a cell
+			//is the cell's neighbour (i+3)%6, and inverted it counts as the other player's
+			for(int p = 0; p < 3; p++){
+				for(int i = 0; i < 6; i++){
+					int shift = 2*(5 - (i+3)%6);
+					m->patternbits[p][i] = (p << shift) | ((p ? 3 - p : 0) << (shift + 16));
+				}
+			}
+
+			for(int y = 0; y < size_d; y++){
+				m->linestart[y] = (y < size ? 0 : y - sizem1);
+				m->lineend[y]   = (y < size ? size + y : size_d);
+
+				for(int x = 0; x < size_d; x++){
+					m->xymove[xy(x, y)] = Move(x, y);
+					m->corner[xy(x, y)] = calc_corner(x, y);
+					m->edge[xy(x, y)]   = calc_edge(x, y);
+
+					//same transforms as update_hash, on coordinates centered on the middle cell
+					int cx = x - sizem1, cy = y - sizem1, cz = cy - cx;
+					const int sym[12][2] = {
+						{ cx,  cy}, { cy,  cz}, { cz, -cx}, {-cx, -cy}, {-cy, -cz}, {-cz,  cx},
+						{ cy,  cx}, { cz,  cy}, {-cx,  cz}, {-cy, -cx}, {-cz, -cy}, { cx, -cz},
+					};
+					for(int k = 0; k < 12; k++)
+						m->symmetry[k][xy(x, y)] = (onboard(x, y) ? xyc(sym[k][0], sym[k][1]) : xy(x, y));
+
+					for(int p = 0; p < 2; p++)
+						for(int k = 0; k < 12; k++)
+							m->zobrist[xy(x, y)][p][k] = Zobrist::string(3*m->symmetry[k][xy(x, y)] + p + 1);
+
+					if(!onboard(x, y))
+						continue;
+
+					m->onboard.set(xy(x, y));
+
+					m->pattern[xy(x, y)] = 0;
+					for(int i = 0; i < 6; i++){
+						if(onboard(Move(x, y) + neighbours[i]))
+							m->nbsrc[i].set(xy(x, y));
+						else
+							m->pattern[xy(x, y)] |= (0x30003 << 2*(5-i));
+					}
+				}
+			}
+
+			statictables[(int)size] = m;
+		}
+
+		return statictables[(int)size];
+	}
+
+public:
 
-	int linestart(int y) const { return (y < size ? 0 : y - sizem1); }
-	int lineend(int y)   const { return (y < size ? size + y : size_d); }
+	int linestart(int y) const { return tables->linestart[y]; }
+	int lineend(int y)   const { return tables->lineend[y]; }
 	int linelen(int y)   const { return size_d - abs(sizem1 - y); }
 
 	string to_s(bool color, bool hguicoords = false) const {
@@ -407,28 +621,90 @@ public:
 
 	void set(const Move & m, bool perm = true){
 		last = m;
-		Cell * cell = & cells[xy(m)];
+		int i = xy(m);
+		Cell * cell = & modcell(i);
 		cell->piece = toPlay;
 		cell->perm = perm;
+		stones[toPlay-1].set(i);
+		add_pattern(i, toPlay);
+		if(inemptylist(i))
+			remove_empty(i);
 		nummoves++;
 		update_hash(m, toPlay); //depends on nummoves
 		toPlay = 3 - toPlay;
 	}
 
-	void unset(const Move & m){ //break win checks, but is a poor mans undo if all you care about is the hash
+	void unset(const Move & m){ //break win checks, but is a poor mans undo if all you care about is the hash, see undo() for the real one
 		toPlay = 3 - toPlay;
 		update_hash(m, toPlay);
 		nummoves--;
-		Cell * cell = & cells[xy(m)];
+		int i = xy(m);
+		Cell * cell = & cells[i];
 		cell->piece = 0;
 		cell->perm = 0;
+		stones[toPlay-1].unset(i);
+		remove_pattern(i, toPlay);
+		if(i < vecsize() && !inemptylist(i))
+			add_empty(i);
+	}
+
+private:
+	//a stone of player p placed on or taken off i changes its neighbours' patterns
+	void add_pattern(int i, int p){
+		const MoveValid * s = nb_begin(i);
+		for(int k = 0; k < 6; k++)
+			if(s[k].onboard())
+				patterns[s[k].xy] += tables->patternbits[p][k];
 	}
+	void remove_pattern(int i, int p){
+		const MoveValid * s = nb_begin(i);
+		for(int k = 0; k < 6; k++)
+			if(s[k].onboard())
+				patterns[s[k].xy] -= tables->patternbits[p][k];
+	}
+
+	//membership test that is safe on stale positions
+	bool inemptylist(int i) const { return (emptypos[i] < num_empty && emptylist[emptypos[i]] == i); }
+
+	void add_empty(int i){
+		emptypos[i] = num_empty;
+		emptylist[num_empty++] = i;
+	}
+
+	//swap the last empty cell into i's place, leaving emptypos[i] pointing at the old place for restore_empty
+	void remove_empty(int i){
+		int p = emptypos[i];
+		int last = emptylist[--num_empty];
+		emptylist[p] = last;
+		emptypos[last] = p;
+	}
+
+	//exact inverse of the most recent remove_empty(i), so the order of the list is restored too
+	void restore_empty(int i){
+		int p = emptypos[i];
+		int moved = emptylist[p];
+		emptylist[num_empty] = moved;
+		emptypos[moved] = num_empty;
+		emptylist[p] = i;
+		emptypos[i] = p;
+		num_empty++;
+	}
+
+public:
 
 	void doswap(){
 		for(int y = 0; y < size_d; y++){
 			for(int x = linestart(y); x < lineend(y); x++){
 				if(get(x,y) != 0){
-					cells[xy(x,y)].piece = 2;
+					int i = xy(x,y);
+					modcell(i).piece = 2;
+					stones[0].unset(i);
+					stones[1].set(i);
+					remove_pattern(i, 1);
+					add_pattern(i, 2);
+					for(const MoveValid * n = nb_begin(i), *e = nb_end(n); n < e; n++) //so player 2's moves next to it join it
+						if(n->onboard())
+							setlocal(n->xy, (3 << 2));
 					toPlay = 1;
 					return;
 				}
@@ -445,7 +721,8 @@ public:
 			do{
 				p = cells[p].parent;
 			}while(p != cells[p].parent);
-			cells[i].parent = p; //do path compression, but only the current one, not all, to avoid recursion
+			if(!journal) //a compressed path could skip over a join that undo later takes back
+				cells[i].parent = p; //do path compression, but only the current one, not all, to avoid recursion
 		}
 		return p;
 	}
@@ -464,10 +741,11 @@ public:
 		if(cells[i].size < cells[j].size) //force i's subtree to be bigger
 			swap(i, j);
 
-		cells[j].parent = i;
-		cells[i].size   += cells[j].size;
-		cells[i].corner |= cells[j].corner;
-		cells[i].edge   |= cells[j].edge;
+		Cell & ci = modcell(i), & cj = modcell(j);
+		cj.parent = i;
+		ci.size   += cj.size;
+		ci.corner |= cj.corner;
+		ci.edge   |= cj.edge;
 
 		return false;
 	}
@@ -579,6 +857,48 @@ public:
 		return false;
 	}
 
+	// bitmask of which of the 6 neighbours of posxy are turn's stones
+	int ownneighbours(int posxy, int turn) const {
+		int own = 0;
+		const MoveValid * s = nb_begin(posxy);
+		for(int i = 0; i < 6; i++)
+			if(s[i].onboard() && cells[s[i].xy].piece == turn)
+				own |= (1 << i);
+		return own;
+	}
+	static int rotate_neighbours(int own, int n){ return ((own << n) | (own >> (6 - n))) & 63; }
+
+	// do an O(1) ring check for a ring of any size, without a search
+	// a new ring through pos leaves it by two neighbours that aren't next to each other. Either they are in two separate
+	// runs of turn's neighbours that were already one group, which move() finds while joining the runs, or they are in
+	// one run and the ring goes around the stones in the middle of the run. Any empty or opponent cell in there would
+	// mean the ring already existed without pos, so those middle stones are now completely surrounded.
+	// must be done after placing the stone, own is ownneighbours() of pos
+	// exact as long as every earlier move was checked for rings, with no minimum size or permanent stones
+	bool checkring_fill(int posxy, int turn, int own) const {
+		int middle = own & rotate_neighbours(own, 1) & rotate_neighbours(own, 5);
+		const MoveValid * s = nb_begin(posxy);
+		for(int i = 0; i < 6; i++)
+			if((middle >> i) & 1 && ownneighbours(s[i].xy, turn) == 63)
+				return true;
+		return false;
+	}
+
+	// whether checkring_df is worth running when no two runs of neighbours were already one group
+	// this is when joining every other neighbour in order would reach the same run twice, as move() used to join them,
+	// ie a run long enough to go around something or a run wrapping past neighbour 0
+	static bool ringcandidate(int own){
+		int joins = 0;
+		for(int i = 0; i < 6; i++){
+			if((own >> i) & 1){
+				joins++;
+				i++;
+			}
+		}
+		int runs = (own == 63 ? 1 : BitsSetTable64[own & ~rotate_neighbours(own, 1)]);
+		return (joins > runs);
+	}
+
 	// do an O(1) ring check
 	// must be done before placing the stone and joining it with the neighbouring groups
 	bool checkring_o1(const Move & pos, const int turn) const {
@@ -722,26 +1042,7 @@ public:
 			return;
 		}
 
-		//mirror is simply flip x,y
-		int x = pos.x - sizem1,
-		    y = pos.y - sizem1,
-		    z = y - x;
-
-//x,y; y,z; z,-x; -x,-y; -y,-z; -z,x
-//y,x; z,y; -x,z; -y,-x; -z,-y; x,-z
-
-		hash.update(0,  3*xyc( x,  y) + turn);
-		hash.update(1,  3*xyc( y,  z) + turn);
-		hash.update(2,  3*xyc( z, -x) + turn);
-		hash.update(3,  3*xyc(-x, -y) + turn);
-		hash.update(4,  3*xyc(-y, -z) + turn);
-		hash.update(5,  3*xyc(-z,  x) + turn);
-		hash.update(6,  3*xyc( y,  x) + turn);
-		hash.update(7,  3*xyc( z,  y) + turn);
-		hash.update(8,  3*xyc(-x,  z) + turn);
-		hash.update(9,  3*xyc(-y, -x) + turn);
-		hash.update(10, 3*xyc(-z, -y) + turn);
-		hash.update(11, 3*xyc( x, -z) + turn);
+		hash.update(tables->zobrist[xy(pos)][turn-1]);
 	}
 
 	hash_t test_hash(const Move & pos) const {
@@ -752,40 +1053,18 @@ public:
 		if(nummoves >= unique_depth) //simple test, no rotations/symmetry
 			return hash.test(0, 3*xy(pos) + turn);
 
-		int x = pos.x - sizem1,
-		    y = pos.y - sizem1,
-		    z = y - x;
-
-		hash_t m = hash.test(0,  3*xyc( x,  y) + turn);
-		m = min(m, hash.test(1,  3*xyc( y,  z) + turn));
-		m = min(m, hash.test(2,  3*xyc( z, -x) + turn));
-		m = min(m, hash.test(3,  3*xyc(-x, -y) + turn));
-		m = min(m, hash.test(4,  3*xyc(-y, -z) + turn));
-		m = min(m, hash.test(5,  3*xyc(-z,  x) + turn));
-		m = min(m, hash.test(6,  3*xyc( y,  x) + turn));
-		m = min(m, hash.test(7,  3*xyc( z,  y) + turn));
-		m = min(m, hash.test(8,  3*xyc(-x,  z) + turn));
-		m = min(m, hash.test(9,  3*xyc(-y, -x) + turn));
-		m = min(m, hash.test(10, 3*xyc(-z, -y) + turn));
-		m = min(m, hash.test(11, 3*xyc( x, -z) + turn));
-		return m;
+		return hash.test(tables->zobrist[xy(pos)][turn-1]);
 	}
 
 	unsigned int sympattern(const Move & pos) const { return sympattern(xy(pos)); }
 	unsigned int sympattern(int posxy)        const { return pattern_symmetry(pattern(posxy)); }
 
 	unsigned int pattern(const Move & pos) const { return pattern(xy(pos)); }
-	unsigned int pattern(int posxy)        const {
-		unsigned int p = 0;
-		for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-			p <<= 2;
-			if(i->onboard())
-				p |= cells[i->xy].piece;
-			else
-				p |= 3;
-		}
-		return p;
-	}
+	//2 bits per neighbour, from 10-11 for neighbour 0 down to 0-1 for neighbour 5: 0 empty, 1,2 for players, 3 offboard
+	unsigned int pattern(int posxy)        const { return patterns[posxy] & 0xFFF; }
+	//the same with the players switched, the same as pattern_invert(pattern(posxy))
+	unsigned int pattern_inv(const Move & pos) const { return pattern_inv(xy(pos)); }
+	unsigned int pattern_inv(int posxy)        const { return patterns[posxy] >> 16; }
 
 	static unsigned int pattern_invert(unsigned int p){ //switch players
 		return ((p & 0xAAA) >> 1) | ((p & 0x555) << 1);
@@ -813,14 +1092,86 @@ public:
 		return m;
 	}
 
+	//start recording moves into j so they can be undone, or stop with NULL
+	void set_journal(Journal * j){
+		journal = j;
+		if(journal)
+			journal->clear();
+	}
+
+	bool can_undo() const { return (journal && journal->depth() > 0); }
+
+	//take back the last move made with move() since set_journal, restoring the groups and win state exactly
+	void undo(){
+		assert(can_undo());
+
+		const Journal::Frame & f = journal->frames[--journal->numframes];
+		for(unsigned int i = journal->numchanges; i > f.changes; i--){
+			const Journal::Change & c = journal->changes[i-1];
+			cells[c.xy] = c.cell;
+		}
+		if(f.movexy >= 0){
+			stones[f.toPlay-1].unset(f.movexy);
+			remove_pattern(f.movexy, f.toPlay);
+			restore_empty(f.movexy);
+			update_hash(xymove(f.movexy), f.toPlay); //xor the stone back out while nummoves is still the post-move value
+		}else{
+			int i = stones[1].first(); //the only stone
+			remove_pattern(i, 2);
+			add_pattern(i, 1);
+			stones[0] = stones[1];
+			stones[1].clear();
+		}
+		journal->numchanges = f.changes;
+
+		last     = f.last;
+		nummoves = f.nummoves;
+		toPlay   = f.toPlay;
+		outcome  = f.outcome;
+		wintype  = f.wintype;
+
+		if(trackwins) //taking a stone back can take away wins anywhere its group reached
+			refresh_wins();
+	}
+
+private:
+	//get a cell to modify, saving its old value if recording for undo
+	Cell & modcell(int i){
+		if(journal)
+			journal->addchange(i, cells[i]);
+		return cells[i];
+	}
+
+	void setlocal(int i, unsigned int bits){
+		if((cells[i].local & bits) != bits)
+			modcell(i).local |= bits;
+	}
+
+	void journal_push(int movexy){
+		Journal::Frame & f = journal->addframe();
+		f.changes   = journal->numchanges;
+		f.last      = last;
+		f.nummoves  = nummoves;
+		f.toPlay    = toPlay;
+		f.outcome   = outcome;
+		f.wintype   = wintype;
+		f.movexy    = movexy;
+	}
+
+public:
 	bool move(const Move & pos, bool checkwin = true, bool locality = false, int ringsize = 6, int permring = 0){
 		assert(outcome < 0);
 
 		if(!valid_move(pos))
 			return false;
 
+		if(journal)
+			journal_push(pos == M_SWAP ? -1 : xy(pos));
+
 		if(pos == M_SWAP){
 			doswap();
+			if(trackwins)
+				refresh_wins();
 			return true;
 		}
 
@@ -834,24 +1185,39 @@ public:
 				MoveScore loc = neighbours[i] + pos;
 
 				if(onboard(loc))
-					cells[xy(loc)].local |= (loc.score << localshift);
+					setlocal(xy(loc), (loc.score << localshift));
 			}
 		}
 
 		int posxy = xy(pos);
 		bool islocal = (local(pos, turn) == 3);
-		bool alreadyjoined = false; //useful for finding rings
-		for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-			if(i->onboard()){
-				cells[i->xy].local |= (3 << localshift);
-				if(islocal && turn == get(i->xy)){
-					alreadyjoined |= join_groups(posxy, i->xy);
-					i++; //skip the next one. If it is the same group,
-						 //it is already connected and forms a corner, which we can ignore
+		int own = (islocal ? ownneighbours(posxy, turn) : 0);
+		bool alreadyjoined = false; //two runs of neighbours were already one group, so this closes a ring
+		int joins = 0; //how many separate groups this stone joined
+		int joinxy[3]; //a stone of each of those groups, and the group as it was before, for update_wins
+		Cell joincell[3];
+		const MoveValid * s = nb_begin(posxy);
+		for(int i = 0; i < 6; i++)
+			if(s[i].onboard())
+				setlocal(s[i].xy, (3 << localshift));
+
+		//join the first stone of each run of neighbours, the rest of the run is already in the same group
+		int runs = (own == 63 ? 1 : own & ~rotate_neighbours(own, 1));
+		for(int i = 0; i < 6; i++){
+			if((runs >> i) & 1){
+				if(trackwins){
+					joinxy[joins] = s[i].xy;
+					joincell[joins] = cells[find_group(s[i].xy)];
 				}
+				bool same = join_groups(posxy, s[i].xy);
+				alreadyjoined |= same;
+				joins += !same;
 			}
 		}
 
+		if(trackwins)
+			update_wins(posxy, turn, joinxy, joincell, joins);
+
 		if(checkwin){
 			Cell * g = & cells[find_group(posxy)];
 			if(g->numedges() >= 3){
@@ -860,7 +1226,9 @@ public:
 			}else if(g->numcorners() >= 2){
 				outcome = turn;
 				wintype = 2;
-			}else if(ringsize && alreadyjoined && g->size >= max(6, ringsize) && checkring_df(pos, turn, ringsize, permring)){
+			}else if(ringsize && g->size >= max(6, ringsize) && (ringsize <= 6 && !permring ?
+					(alreadyjoined || checkring_fill(posxy, turn, own)) :
+					((alreadyjoined || ringcandidate(own)) && checkring_df(pos, turn, ringsize, permring)))){
 				outcome = turn;
 				wintype = 3;
 			}else if(nummoves == num_cells){
@@ -903,5 +1271,197 @@ public:
 
 		return -3;
 	}
+
+	//the empty cells where turn wins by playing, the same cells as test_win(cell, turn, checkrings) > 0 but all at once
+	//while tracking this is just the maintained sets, otherwise see scan_wins
+	BitBoard winmask(char turn, bool checkrings = true) const {
+		if(trackwins && !checkrings)
+			return wincells[turn-1];
+		if(trackwins && trackrings)
+			return wincells[turn-1] | ringcells[turn-1];
+
+		BitBoard wins, rings;
+		scan_wins(turn, wins, rings, checkrings);
+		return wins |= rings;
+	}
+
+	//maintain the winmask of both players incrementally from now on, at a small cost on every move
+	//only the cells near each move or on the frontier of a group it grew need a new look, see update_wins
+	//leaving out rings saves most of that cost, and turning them off later is free
+	void track_wins(bool track, bool rings = true){
+		bool rescan = (track && (!trackwins || (rings && !trackrings)));
+		if(trackrings && !rings)
+			for(int p = 0; p < 2; p++)
+				ringcells[p].clear();
+		trackwins = track;
+		trackrings = rings;
+		if(rescan)
+			refresh_wins();
+	}
+	bool tracking_wins() const { return trackwins; }
+
+private:
+	//one pass over turn's stones spreads the corners and edges of each one's group onto its neighbours, so there
+	//is one find_group per stone instead of up to six per empty cell, then each empty cell is a couple of lookups
+	//a cell that wins both ways is only in wins
+	void scan_wins(char turn, BitBoard & wins, BitBoard & rings, bool checkrings) const {
+		uint16_t reach[maxvecsize];  //corner bits | edge bits << 6 of the groups each cell neighbours
+		uint8_t  around[maxvecsize]; //which directions each cell has one of turn's stones in
+		memset(reach, 0, sizeof(uint16_t)*vecsize());
+		memset(around, 0, sizeof(uint8_t)*vecsize());
+
+		const BitBoard & mine = stones[turn-1];
+		int numstones = 0;
+		for(int i = mine.first(); i >= 0; i = mine.next(i)){
+			numstones++;
+			const Cell * g = & cells[find_group(i)];
+			int bits = g->corner | (g->edge << 6);
+			const MoveValid * n = nb_begin(i);
+			for(int d = 0; d < 6; d++){
+				if(n[d].onboard()){
+					reach[n[d].xy] |= bits;
+					around[n[d].xy] |= (1 << d);
+				}
+			}
+		}
+
+		wins.clear();
+		rings.clear();
+		checkrings &= (numstones >= 5); //a ring needs at least 5 stones already
+		for(int k = 0; k < num_empty; k++){
+			int i = emptylist[k];
+			int r = reach[i] | cells[i].corner | (cells[i].edge << 6);
+			if(BitsSetTable64[r & 63] >= 2 || BitsSetTable64[r >> 6] >= 3)
+				wins.set(i);
+			else if(checkrings && ringpair(around[i]) && checkring_o1(xymove(i), turn))
+				rings.set(i);
+		}
+	}
+
+	//needs 2 stones as non-adjacent neighbours before the o1 ring test is worth doing
+	static bool ringpair(int a){
+		return (a & (((a << 2) | (a >> 4)) & 63)) || (a & (((a << 3) | (a >> 3)) & 63));
+	}
+
+	void refresh_wins(){
+		for(int p = 0; p < 2; p++)
+			scan_wins(p+1, wincells[p], ringcells[p], trackrings);
+	}
+
+	//the same test as scan_wins for a single empty cell, but only the parts that can have changed
+	//corner and edge wins only ever appear, but checkring_o1 only looks for the smallest ring once the cell
+	//has 3 or more neighbours in a row, so a ring win can disappear when a neighbour is filled in
+	void rescan_win(int i, char turn, bool reach, bool rings){
+		if(wincells[turn-1].test(i))
+			return;
+
+		int r = cells[i].corner | (cells[i].edge << 6), a = 0;
+		const MoveValid * n = nb_begin(i);
+		for(int d = 0; d < 6; d++){
+			if(n[d].onboard() && cells[n[d].xy].piece == turn){
+				if(reach && !((a << 1) & (1 << d))){ //neighbours next to each other are in the same group
+					const Cell * g = & cells[find_group(n[d].xy)];
+					r |= g->corner | (g->edge << 6);
+				}
+				a |= (1 << d);
+			}
+		}
+
+		if(reach && (BitsSetTable64[r & 63] >= 2 || BitsSetTable64[r >> 6] >= 3)){
+			wincells[turn-1].set(i);
+		}else if(rings){
+			ringcells[turn-1].unset(i);
+			if(ringpair(a) && checkring_o1(xymove(i), turn))
+				ringcells[turn-1].set(i);
+		}
+	}
+
+	//turn just played posxy and merged it with the groups in joincell. The opponent's sets only lose posxy,
+	//since their groups and the stones their rings need are unchanged. For turn, a cell's reach only changes
+	//if it borders a group that gained corners or edges. A new ring runs through the group posxy is now in,
+	//so needs it to have 5 stones, and is either within 2 of posxy or borders two of the merged groups,
+	//one of which isn't the biggest. Most moves in a rollout touch a handful of cells or none at all
+	void update_wins(int posxy, char turn, const int * joinxy, const Cell * joincell, int joins){
+		for(int p = 0; p < 2; p++){
+			wincells[p].unset(posxy);
+			ringcells[p].unset(posxy);
+		}
+
+		const Cell * g = & cells[find_group(posxy)];
+		int bits = g->corner | (g->edge << 6);
+		bool rings = (trackrings && g->size >= 5);
+
+		const MoveValid * s = nb_begin(posxy);
+		int around = 0; //which neighbours are turn's
+		for(int d = 0; d < 6; d++)
+			if(s[d].onboard() && cells[s[d].xy].piece == turn)
+				around |= (1 << d);
+
+		//a neighbour next to a stone of the one group posxy joined already had that group's reach
+		int reached = 0;
+		if(joins == 1 && (joincell[0].corner | (joincell[0].edge << 6)) == bits)
+			reached = ((around << 1) | (around >> 1) | (around << 5) | (around >> 5)) & 63;
+
+		for(int d = 0; d < 6; d++){
+			int i = s[d].xy;
+			if(s[d].onboard() && !cells[i].piece){
+				bool reach = (bits && !((reached >> d) & 1));
+				bool ring = (rings || ringcells[turn-1].test(i)); //filling in a neighbour can hide a ring from checkring_o1
+				if(reach || ring)
+					rescan_win(i, turn, reach, ring);
+			}
+		}
+
+		//a cell 2 away only sees posxy as one of the stones behind its neighbours that checkring_back looks at,
+		//which needs one of turn's stones between them. s[6+d] is past neighbour d, s[12+d] between d and d+1
+		if(rings && around){
+			int between = around | ((around >> 1) | (around << 5));
+			for(int d = 0; d < 6; d++){
+				if(((around >> d) & 1) && s[6+d].onboard() && !cells[s[6+d].xy].piece)
+					rescan_win(s[6+d].xy, turn, false, true);
+				if(((between >> d) & 1) && s[12+d].onboard() && !cells[s[12+d].xy].piece)
+					rescan_win(s[12+d].xy, turn, false, true);
+			}
+		}
+
+		if(joins == 0)
+			return;
+
+		int biggest = 0;
+		for(int k = 1; k < joins; k++)
+			if(joincell[k].size > joincell[biggest].size)
+				biggest = k;
+
+		for(int k = 0; k < joins; k++){
+			bool reach = ((joincell[k].corner | (joincell[k].edge << 6)) != bits);
+			bool ring = (rings && k != biggest);
+			if(reach || ring)
+				rescan_group(joinxy[k], posxy, turn, reach, ring);
+		}
+	}
+
+	//rescan the frontier of the group that start was in before posxy joined it, by flood filling around posxy
+	//its stones all touch since neighbours are always joined
+	void rescan_group(int start, int posxy, char turn, bool reach, bool rings){
+		uint16_t stack[maxvecsize];
+		BitBoard seen;
+		int n = 0;
+		stack[n++] = start;
+		seen.set(start);
+		seen.set(posxy);
+		while(n > 0){
+			int cur = stack[--n];
+			for(const MoveValid * i = nb_begin(cur), *e = nb_end(i); i < e; i++){
+				if(!i->onboard() || seen.test(i->xy))
+					continue;
+				seen.set(i->xy);
+				int p = cells[i->xy].piece;
+				if(p == turn)
+					stack[n++] = i->xy;
+				else if(p == 0)
+					rescan_win(i->xy, turn, reach, rings);
+			}
+		}
+	}
 };
 
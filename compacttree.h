@@ -14,11 +14,53 @@
  * compacting the empty space and freeing it back to the OS. It can scan memory since it is a contiguous block
  * of memory with no fragmentation.
  * Your tree Node should include an instance of CompactTree<Node>::Children named 'children'
+ * Compiled with COMPACT, Children hold a 32bit handle instead of a pointer, saving 4 bytes in every Node.
  */
+
+#ifdef COMPACT
+//Every chunk of every CompactTree gets a slot here. A handle is the slot in the top bits and the offset
+//within the chunk in 8 byte words in the rest. Slot 0 is never used so a NULL handle stays NULL.
+struct ChunkSlots {
+	static const unsigned int OFFBITS = 21; //enough for CHUNK_SIZE
+	static const unsigned int NUM = 1 << (32 - OFFBITS); //so up to 32gb across all trees
+
+	static char ** mem(){
+		static char * slots[NUM];
+		return slots;
+	}
+	static unsigned int take(char * m){
+		char ** slots = mem();
+		for(unsigned int i = 1; i < NUM; i++)
+			if(slots[i] == NULL && CAS(slots[i], (char *)NULL, m))
+				return i;
+		assert(false && "Out of CompactTree chunk slots");
+		return 0;
+	}
+	static void give(unsigned int i){
+		mem()[i] = NULL;
+	}
+};
+#endif
+
 template <class Node> class CompactTree {
 	static const unsigned int CHUNK_SIZE = 16*1024*1024;
 	static const unsigned int MAX_NUM = 300; //maximum amount of Node's to allocate at once, needed for size of freelist
 
+	struct Data;
+	struct Chunk;
+
+#ifdef COMPACT
+	typedef uint32_t Handle;
+	static Data * get(Handle h){
+		return (Data *)(ChunkSlots::mem()[h >> ChunkSlots::OFFBITS] + ((h & ((1 << ChunkSlots::OFFBITS) - 1)) << 3));
+	}
+#else
+	typedef Data * Handle;
+	static Data * get(Handle h){
+		return h;
+	}
+#endif
+
 	//Hold a list of children within the compact tree
 	struct Data {
 		const static uint32_t oldcount = 4; //how many generations it needs to be empty before it's considered old
@@ -26,14 +68,22 @@ template <class Node> class CompactTree {
 		uint16_t    capacity; //number of Node's worth of memory to follow
 		uint16_t    used;     //number of children to follow that are actually used, num <= capacity
 		//sizes are chosen such that they add to a multiple of word size on 32bit and 64bit machines.
+#ifdef COMPACT
+		Handle      self;     //handle to this Data instance, for the parent to reference
+#endif
+		uint16_t    stamp;    //generation this was last walked through
+		uint16_t    born;     //generation this was allocated in
 
 		union {
-			Data ** parent;  //pointer to the Data* in the parent Node that references this Data instance
+			Handle * parent;  //pointer to the handle in the parent Node that references this Data instance
 			Data *  nextfree; //next free Data block of this size when in the free list
 		};
 		Node        children[0]; //array of Nodes, runs past the end of the data block
 
-		Data(unsigned int n, Data ** p) : capacity(n), used(n), parent(p) {
+		Data(unsigned int n, Handle * p, Handle h, uint16_t gen) : capacity(n), used(n), stamp(gen), born(gen), parent(p) {
+#ifdef COMPACT
+			self = h;
+#endif
 			header = (((unsigned long)this >> 2) & 0xFFFF) | (0xBEEF << 16);
 			if(empty()) header += 0xABCD;
 
@@ -54,6 +104,12 @@ template <class Node> class CompactTree {
 		bool empty() const { return (header <= oldcount); }
 		bool old()   const { return (header == oldcount); }
 
+#ifdef COMPACT
+		Handle handle() const { return self; }
+#else
+		Handle handle() { return this; }
+#endif
+
 		Node * begin(){
 			return children;
 		}
@@ -78,16 +134,19 @@ template <class Node> class CompactTree {
 
 		//make sure the parent points back to the same place
 		bool parent_consistent() const {
-			return (header == (*parent)->header);
+			return (header == get(*parent)->header);
 		}
 
 		//called after moving the memory to update the parent pointers for this node and its children
-		void move(Data * s){
+		void move(Data * s, Handle h){
 			assert(!empty()); //don't move an empty Data segment
-			assert(*parent == s); //my parent points to my old location
+			assert(get(*parent) == s); //my parent points to my old location
 
 			//update my parent with my new location
-			*parent = this;
+#ifdef COMPACT
+			self = h;
+#endif
+			*parent = h;
 
 			//make sure the parent points back to the same place
 			assert(parent_consistent());
@@ -95,8 +154,8 @@ template <class Node> class CompactTree {
 			//update my children
 			for(Node * i = begin(), * e = end(); i != e; ++i){
 				if(i->children.data){
-					i->children.data->parent = &(i->children.data);
-					assert(i->children.data->parent_consistent());
+					get(i->children.data)->parent = &(i->children.data);
+					assert(get(i->children.data)->parent_consistent());
 				}
 			}
 		}
@@ -105,58 +164,85 @@ template <class Node> class CompactTree {
 public:
 	//Sits in Node to manage the children, which are actually stored in a Data struct
 	class Children {
-		static const int LOCK = 1; //must be cast to (Data *) at usage point
-		Data * data;
+		static const int LOCK = 1; //must be cast to (Handle) at usage point
+		Handle data;
 		friend class Data;
 
 	public:
 		typedef Node * iterator;
-		Children() : data(NULL) { }
-		~Children() { assert(data == NULL); }
+		Children() : data(0) { }
+		~Children() { assert(data == 0); }
 
 		//lock the children, so only one thread creates them at a time, returns false if another thread already has the lock
-		bool lock()   { return CAS(data, (Data *) NULL, (Data *) LOCK); }
-		bool unlock() { return CAS(data, (Data *) LOCK, (Data *) NULL); }
+		bool lock()   { return CAS(data, (Handle) 0, (Handle) LOCK); }
+		bool unlock() { return CAS(data, (Handle) LOCK, (Handle) 0); }
 
 		//allocate n nodes, likely best used in a temporary node and swapped in
 		unsigned int alloc(unsigned int n, CompactTree & ct){
-			assert(data == NULL);
-			data = ct.alloc(n, &data);
+			assert(data == 0);
+			data = ct.alloc(n, &data)->handle();
 			return n;
 		}
 
 		//deallocate the children
 		unsigned int dealloc(CompactTree & ct){
-			Data * t = data;
+			Handle t = data;
 			int n = 0;
-			if(t && CAS(data, t, (Data*)NULL)){
-				n = t->used;
-				ct.dealloc(t);
+			if(t && CAS(data, t, (Handle) 0)){
+				n = get(t)->used;
+				ct.dealloc(get(t));
 			}
 			return n;
 		}
 		//swap children with the other node, used for threadsafe child creation
 		void swap(Children & other){
-			//swap data pointer
-			Data * temp;
+			//swap data handle
+			Handle temp;
 			temp = data;
 			data = other.data;
 			other.data = temp;
-			temp = NULL;
 
 			//update parent pointer
-			if(data > (Data*)LOCK)
-				data->parent = &data;
-			if(other.data > (Data*)LOCK)
-				other.data->parent = &(other.data);
+			if(data > (Handle) LOCK)
+				get(data)->parent = &data;
+			if(other.data > (Handle) LOCK)
+				get(other.data)->parent = &(other.data);
+		}
+		//move the children to an empty Children with a fixed address, leaving this one empty. Other threads may still be
+		//reading the children, so only free them once they're done. Only one thread may detach at a time, and not while compacting
+		bool detach(Children & to){
+			Handle t = data;
+			if(t > (Handle) LOCK && CAS(data, t, (Handle) 0)){
+				assert(to.data == 0);
+				to.data = t;
+				get(t)->parent = &(to.data);
+				return true;
+			}
+			return false;
+		}
+		//mark the children as walked through in this generation, only writing if it changed to keep the cache line clean
+		void stamp(uint16_t gen){
+			Handle d = data;
+			if(d > (Handle) LOCK && get(d)->stamp != gen)
+				get(d)->stamp = gen;
+		}
+		//how many generations since the children were last walked through, 0 if there are none
+		uint16_t age(uint16_t gen) const {
+			Handle d = data;
+			return (d > (Handle) LOCK ? (uint16_t)(gen - get(d)->stamp) : 0);
+		}
+		//were the children allocated before this generation, 0 if there are none
+		bool older(uint16_t gen) const {
+			Handle d = data;
+			return (d > (Handle) LOCK && get(d)->born != gen);
 		}
 		//keep only the first n children, used if too many children were allocated
 		int shrink(int n){
-			return data->shrink(n);
+			return get(data)->shrink(n);
 		}
 		//how many children are there?
 		unsigned int num() const {
-			return (data > (Data *) LOCK ? data->used : 0);
+			return (data > (Handle) LOCK ? get(data)->used : 0);
 		}
 		//does this node have any children?
 		bool empty() const {
@@ -164,25 +250,36 @@ public:
 		}
 		//access a child at a specific offset
 		Node & operator[](unsigned int offset){
-			assert(data > (Data *) LOCK);
-			assert(offset >= 0 && offset < data->used);
-			return data->children[offset];
+			assert(data > (Handle) LOCK);
+			assert(offset >= 0 && offset < get(data)->used);
+			return get(data)->children[offset];
 		}
 		//iterator through the children
 		Node * begin() const {
-			if(data > (Data *) LOCK)
-				return data->begin();
+			if(data > (Handle) LOCK)
+				return get(data)->begin();
 			return NULL;
 		}
 		//end of the iterator through the children
 		Node * end() const {
-			if(data > (Data *) LOCK)
-				return data->end();
+			if(data > (Handle) LOCK)
+				return get(data)->end();
+			return NULL;
+		}
+		//begin and end from a single read, for threads that may race with another thread creating or detaching the children
+		Node * range(Node * & cend) const {
+			Handle d = data;
+			if(d > (Handle) LOCK){
+				cend = get(d)->end();
+				return get(d)->begin();
+			}
+			cend = NULL;
 			return NULL;
 		}
 		//find a node associated with a move
 		Node * find(const Move & m) const {
-			for(Node * c = begin(), * cend = end(); c != cend; c++)
+			Node * cend, * c = range(cend);
+			for(; c != cend; c++)
 				if(c->move == m)
 					return c;
 			return NULL;
@@ -197,6 +294,9 @@ private:
 		uint32_t capacity; //in bytes
 		uint32_t used;     //in bytes
 		char *   mem;  //actual memory
+#ifdef COMPACT
+		uint32_t slot; //in ChunkSlots, for handles into this chunk
+#endif
 
 		Chunk()               : next(NULL), id(0), capacity(0), used(0), mem(NULL) { }
 		Chunk(unsigned int c) : next(NULL), id(0), capacity(0), used(0), mem(NULL) { alloc(c); }
@@ -207,6 +307,10 @@ private:
 			capacity = c;
 			used = 0;
 			mem = (char*) new uint64_t[capacity / sizeof(uint64_t)]; //use uint64_t instead of char to guarantee alignment
+#ifdef COMPACT
+			assert(capacity <= (8u << ChunkSlots::OFFBITS));
+			slot = ChunkSlots::take(mem);
+#endif
 		}
 		void dealloc(bool deallocnext = false){
 			assert(capacity > 0 && mem != NULL);
@@ -218,6 +322,9 @@ private:
 			assert(next == NULL);
 			capacity = 0;
 			used = 0;
+#ifdef COMPACT
+			ChunkSlots::give(slot);
+#endif
 			delete[] (uint64_t *)mem;
 			mem = NULL;
 		}
@@ -228,6 +335,15 @@ private:
 		}
 	};
 
+	//the handle to a Data instance at this offset in this chunk
+	static Handle handle(Chunk * c, unsigned int off){
+#ifdef COMPACT
+		return (c->slot << ChunkSlots::OFFBITS) | (off >> 3);
+#else
+		return (Data *)(c->mem + off);
+#endif
+	}
+
 	class Freelist {
 		Data * list[MAX_NUM];
 		SpinLock lock;
@@ -273,6 +389,7 @@ private:
 	unsigned int numchunks;
 	Freelist freelist;
 	uint64_t memused;
+	volatile uint16_t generation; //new Data are born and stamped in this generation
 
 public:
 
@@ -281,6 +398,7 @@ public:
 		head = current = last = new Chunk(CHUNK_SIZE);
 		numchunks = 1;
 		memused = 0;
+		generation = 1;
 	}
 	~CompactTree(){
 		head->dealloc(true);
@@ -289,6 +407,10 @@ public:
 		numchunks = 0;
 	}
 
+	//the generation is advanced by each garbage collection, so the age of a stamp counts the collections since it was walked through
+	uint16_t gen() const { return generation; }
+	void next_gen(){ generation++; }
+
 	//how much memory is malloced and available for use
 	uint64_t memarena() const {
 		Chunk * c = current;
@@ -309,7 +431,12 @@ public:
 		return memused;
 	}
 
-	Data * alloc(unsigned int num, Data ** parent){
+	//bytes for a block of num children, including the Data header
+	static unsigned int memsize(unsigned int num) {
+		return sizeof(Data) + sizeof(Node)*num;
+	}
+
+	Data * alloc(unsigned int num, Handle * parent){
 		assert(num > 0 && num < MAX_NUM);
 
 		unsigned int size = sizeof(Data) + sizeof(Node)*num;
@@ -318,7 +445,7 @@ public:
 	//check freelist
 		if(Data * t = freelist.pop(num)){
 			assert(t->empty() && t->capacity == num);
-			return new(t) Data(num, parent);
+			return new(t) Data(num, parent, t->handle(), generation);
 		}
 
 	//allocate new memory
@@ -327,7 +454,7 @@ public:
 			uint32_t used = c->used;
 			if(used + size <= c->capacity){ //if there is room, try to use it
 				if(CAS(c->used, used, used+size))
-					return new((Data *)(c->mem + used)) Data(num, parent);
+					return new((Data *)(c->mem + used)) Data(num, parent, handle(c, used), generation);
 				else
 					continue;
 			}else if(c->next != NULL){ //if there is a next chunk, advance to it and try again
@@ -359,7 +486,7 @@ public:
 		assert(!d->empty() && d->capacity > 0 && d->capacity < MAX_NUM);
 
 		unsigned int size = d->memsize();
-		PLUS(memused, -size);
+		PLUS(memused, -(uint64_t)size);
 
 		//call the destructor
 		d->~Data();
@@ -421,14 +548,17 @@ public:
 					assert(s->used > 0 && s->used <= s->capacity);
 					int dsize = s->memused(); //how much to move the dest pointer
 					Data * d = NULL;
+					Handle h;
 
 					//where to move
 					while(1){
 						if((d = freelist.pop_nolock(s->used))){ //allocate off the freelist if possible
+							h = d->handle();
 							break;
 						}else if(doff + dsize <= dchunk->capacity){ //if space, allocate from this chunk
 							assert(schunk->id > dchunk->id || (schunk == dchunk && soff >= doff)); //make sure I'm moving left
 							d = (Data *)(dchunk->mem + doff);
+							h = handle(dchunk, doff);
 							doff += dsize;
 							break;
 						}else{ //otherwise finish this chunk and prepare the next
@@ -444,7 +574,7 @@ public:
 					s->capacity = s->used;
 					if(s != d){
 						memmove(d, s, dsize);
-						d->move(s);
+						d->move(s, h);
 					}
 					memused += dsize;
 				}
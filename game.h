@@ -8,17 +8,27 @@
 class HavannahGame {
 	vector<Move> hist;
 	int size;
+	int unique_depth; //passed on to every board, see Board::set_unique_depth
 
 public:
 
-	HavannahGame(int s = 8){
+	HavannahGame(int s = 8, int u = 5){
 		size = s;
+		unique_depth = u;
 	}
 
 	int getsize() const {
 		return size;
 	}
 
+	int get_unique_depth() const {
+		return unique_depth;
+	}
+
+	void set_unique_depth(int u){
+		unique_depth = u;
+	}
+
 	const vector<Move> & get_hist() const {
 		return hist;
 	}
@@ -32,6 +42,7 @@ public:
 
 	Board getboard(int offset = 0) const {
 		Board board(size);
+		board.set_unique_depth(unique_depth);
 		if(offset <= 0)
 			offset += hist.size();
 		for(int i = 0; i < offset; i++)
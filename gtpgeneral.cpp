@@ -41,6 +41,22 @@ GTPResponse HavannahGTP::gtp_swap(vecstr args){
 	return GTPResponse(true, ret);
 }
 
+GTPResponse HavannahGTP::gtp_unique_depth(vecstr args){
+	if(args.size() == 0)
+		return GTPResponse(true, to_str(game.get_unique_depth()));
+
+	int depth = from_str<int>(args[0]);
+	if(depth < 0)
+		return GTPResponse(false, "Depth can't be negative");
+
+	log("unique_depth " + args[0]);
+
+	game.set_unique_depth(depth);
+	set_board();
+
+	return GTPResponse(true);
+}
+
 GTPResponse HavannahGTP::gtp_boardsize(vecstr args){
 	if(args.size() != 1)
 		return GTPResponse(false, "Current board size: " + to_str(game.getsize()));
@@ -48,10 +64,10 @@ GTPResponse HavannahGTP::gtp_boardsize(vecstr args){
 	log("boardsize " + args[0]);
 
 	int size = from_str<int>(args[0]);
-	if(size < 3 || size > 10)
+	if(size < 3 || size > Board::maxsize)
 		return GTPResponse(false, "Size " + to_str(size) + " is out of range.");
 
-	game = HavannahGame(size);
+	game = HavannahGame(size, game.get_unique_depth());
 	set_board();
 
 	time_remain = time.game;
@@ -307,3 +323,124 @@ GTPResponse HavannahGTP::gtp_zobrist(vecstr args){
 	return GTPResponse(true, game.getboard().hashstr());
 }
 
+
+GTPResponse HavannahGTP::gtp_bench_board(vecstr args){
+	int size = game.getsize();
+	double len = 1;
+
+	if(args.size() >= 1)
+		size = from_str<int>(args[0]);
+	if(args.size() >= 2)
+		len = from_str<double>(args[1]);
+
+	if(size < 3 || size > Board::maxsize)
+		return GTPResponse(false, "Size " + to_str(size) + " is out of range.");
+
+	XORShift_uint32 rand32;
+	Board start(size);
+
+	uint64_t games = 0, played = 0;
+	double used = 0;
+	Time starttime;
+	do{
+		for(int g = 0; g < 100; g++){
+			Board board = start;
+
+			//choose uniformly from the remaining moves, same as the rollouts
+			while(board.won() < 0){
+				board.move(board.emptymove(rand32() % board.numempty()), true, false);
+				played++;
+			}
+			games++;
+		}
+		used = Time() - starttime;
+	}while(used < len);
+
+	//copies of a half full board, as the players and solvers make at every simulation or node
+	Board half = start;
+	for(Board::MoveIterator m = half.moveit(false, false); !m.done() && half.num_moves() < half.numcells()/2; ++m)
+		if(rand32() % 2)
+			half.move(*m, false, false);
+
+	uint64_t copies = 0;
+	volatile int sink = 0; //keep the copies from being optimized away, output as a checksum
+	double copyused = 0;
+	starttime = Time();
+	do{
+		for(int c = 0; c < 10000; c++){
+			Board board = half;
+			sink += board.get(c % board.vecsize());
+		}
+		copies += 10000;
+		copyused = Time() - starttime;
+	}while(copyused < len/4);
+
+	//visit every child of the half full board, by copying it or by making and undoing the move as the solvers do
+	uint64_t children = 0, undos = 0;
+	double childused = 0, undoused = 0;
+	starttime = Time();
+	do{
+		for(Board::MoveIterator m = half.moveit(false, false); !m.done(); ++m){
+			Board next = half;
+			next.move(*m, true, false);
+			sink += next.won();
+			children++;
+		}
+		childused = Time() - starttime;
+	}while(childused < len/4);
+
+	Board::Journal journal;
+	half.set_journal(&journal);
+	starttime = Time();
+	do{
+		for(Board::MoveIterator m = half.moveit(false, false); !m.done(); ++m){
+			half.move(*m, true, false);
+			sink += half.won();
+			half.undo();
+			undos++;
+		}
+		undoused = Time() - starttime;
+	}while(undoused < len/4);
+
+	return GTPResponse(true, "size " + to_str(size) + ": " + to_str((uint64_t)(games/used)) + " games/s, " + to_str((uint64_t)(played/used)) + " moves/s, " + to_str((uint64_t)(copies/copyused)) + " copies/s, " +
+		to_str((uint64_t)(children/childused)) + " copy+move/s, " + to_str((uint64_t)(undos/undoused)) + " move+undo/s, checksum " + to_str(sink));
+}
+
+GTPResponse HavannahGTP::gtp_bench_rings(vecstr args){
+	double len = 1;
+	int minringsize = 6, ringperm = 0;
+
+	if(args.size() >= 1)
+		len = from_str<double>(args[0]);
+	if(args.size() >= 2)
+		minringsize = from_str<int>(args[1]);
+	if(args.size() >= 3)
+		ringperm = from_str<int>(args[2]);
+
+	Board start = game.getboard();
+	if(start.won() >= 0)
+		return GTPResponse(false, "The game is already over");
+
+	XORShift_uint32 rand32;
+
+	//finish the game randomly like the rollouts do, with every move checked for rings
+	//play a ring heavy position first, like the ones in test/assign1, for the slow ring checks to matter
+	uint64_t games = 0, played = 0, rings = 0;
+	double used = 0;
+	Time starttime;
+	do{
+		for(int g = 0; g < 100; g++){
+			Board board = start;
+			while(board.won() < 0){
+				board.move(board.emptymove(rand32() % board.numempty()), true, false, minringsize, ringperm);
+				played++;
+			}
+			rings += (board.getwintype() == 3);
+			games++;
+		}
+		used = Time() - starttime;
+	}while(used < len);
+
+	return GTPResponse(true, to_str((uint64_t)(games/used)) + " games/s, " + to_str((uint64_t)(played/used)) + " moves/s, " +
+		to_str(100.0*rings/games, 1) + "% rings");
+}
@@ -2,6 +2,7 @@
 
 #include "havannahgtp.h"
 #include "fileio.h"
+#include "weightedrandtree.h"
 #include <fstream>
 
 using namespace std;
@@ -142,6 +143,7 @@ GTPResponse HavannahGTP::gtp_player_solve(vecstr args){
 
 	DepthStats gamelen, treelen;
 	uint64_t runs = player.runs;
+	uword proofs = player.proofs, proofattempts = player.proofattempts;
 	DepthStats wintypes[2][4];
 	double times[4] = {0,0,0,0};
 	for(unsigned int i = 0; i < player.threads.size(); i++){
@@ -158,11 +160,17 @@ GTPResponse HavannahGTP::gtp_player_solve(vecstr args){
 		player.threads[i]->reset();
 	}
 	player.runs = 0;
+	player.proofs = 0;
+	player.proofattempts = 0;
 
 	string stats = "Finished " + to_str(runs) + " runs in " + to_str(player.time_used*1000, 0) + " msec: " + to_str(runs/player.time_used, 0) + " Games/s\n";
 	if(runs > 0){
 		stats += "Game length: " + gamelen.to_s() + "\n";
 		stats += "Tree depth:  " + treelen.to_s() + "\n";
+		if(player.tt.size())
+			stats += "Transpositions: " + to_str(player.tt.num()) + " positions, " + to_str(100.0*player.tt.num()/player.tt.size(), 1) + "% full\n";
+		if(player.provers)
+			stats += "Provers:     " + to_str(proofs) + " proofs in " + to_str(proofattempts) + " attempts\n";
 		if(player.profile)
 			stats += "Times:       " + to_str(times[0], 3) + ", " + to_str(times[1], 3) + ", " + to_str(times[2], 3) + ", " + to_str(times[3], 3) + "\n";
 		stats += "Win Types:   ";
@@ -238,6 +246,316 @@ GTPResponse HavannahGTP::gtp_player_solved(vecstr args){
 	return GTPResponse(true, won_str(3 - toplay));
 }
 
+GTPResponse HavannahGTP::gtp_player_stress(vecstr args){
+	int numthreads = 32;
+	double len = 1;
+
+	if(args.size() >= 1)
+		numthreads = from_str<int>(args[0]);
+	if(args.size() >= 2)
+		len = from_str<double>(args[1]);
+
+	if(player.rootboard.won() >= 0)
+		return GTPResponse(false, "The game is already over");
+
+	//search from this position with many threads, then check the tree they built together
+	int oldthreads = player.numthreads;
+	bool p = player.ponder;
+	player.set_ponder(false);
+	player.numthreads = numthreads;
+	player.reset_threads();
+
+	player.reclaim_wait(); //so the node count only changes by what this search grows
+	uword nodesbefore = player.nodes;
+	player.genmove(len, 0, false);
+	uint64_t runs = player.runs;
+	player.runs = 0;
+
+	uword errors = player.check_tree(& player.root);
+	for(unsigned int i = 0; i < player.roots.size(); i++)
+		errors += player.check_tree(& player.roots[i]);
+
+	player.numthreads = oldthreads;
+	player.reset_threads();
+	player.set_ponder(p);
+
+	return GTPResponse(errors == 0, to_str(numthreads) + " threads, " + to_str((uint64_t)(runs/player.time_used)) + " runs/s, " +
+		to_str(player.nodes - nodesbefore) + " nodes, " + to_str(errors) + " errors");
+}
+
+GTPResponse HavannahGTP::gtp_bench_choose(vecstr args){
+	double len = 1;
+	if(args.size() >= 1)
+		len = from_str<double>(args[0]);
+
+	if(player.rootboard.won() >= 0)
+		return GTPResponse(false, "The game is already over");
+
+	//a node with made up stats for every move on this board, a few of them already lost
+	XORShift_uint32 rand(std::rand());
+	Player::Node node;
+	player.create_children_simple(player.rootboard, & node);
+	for(Player::Node * child = node.children.begin(); child != node.children.end(); child++){
+		int n = rand() % 1000, r = rand() % 5000;
+		Player::ExpPair rave;
+		child->exp.addwins(rand() % (n+1));
+		child->exp.addlosses(n);
+		rave.addwins(rand() % (r+1));
+		rave.addlosses(r);
+		child->rave = rave;
+		child->know = rand() % 40;
+		if(rand() % 20 == 0)
+			child->outcome = 3 - player.rootboard.toplay();
+		node.exp.addv(child->exp);
+	}
+
+	bool p = player.ponder;
+	player.set_ponder(false);
+
+	Player::PlayerUCT * thread = (Player::PlayerUCT *) player.threads[0];
+	Player::Node * scalar, * simd;
+	double scalarrate = thread->time_choose(& node, player.rootboard.toplay(), false, len, scalar);
+	double simdrate   = thread->time_choose(& node, player.rootboard.toplay(), true,  len, simd);
+
+	player.set_ponder(p);
+	unsigned int num = node.children.num();
+	PLUS(player.nodes, -node.dealloc(player.ctmem));
+
+	return GTPResponse(scalar == simd, to_str(num) + " children, scalar " + to_str((uint64_t)scalarrate) + " calls/s, simd " +
+		to_str((uint64_t)simdrate) + " calls/s, " + (scalar == simd ? "same choice" : "different choice"));
+}
+
+GTPResponse HavannahGTP::gtp_benchmark(vecstr args){
+	uint64_t runs = 20000;
+	int numthreads = 4;
+
+	if(args.size() >= 1)
+		runs = from_str<uint64_t>(args[0]);
+	if(args.size() >= 2)
+		numthreads = from_str<int>(args[1]);
+
+	//empty boards like the speed tests, and positions from the middle of recorded games, in hgui coords
+	struct { int size; const char * moves; } positions[] = {
+		{4, ""},
+		{6, ""},
+		{8, ""},
+		{5, "g5 i5 h5 i6 h7 i8 h8 i9 i7 h9 e9 g8 d7 e6 c5 a5 e4 d5"},
+		{8, "c3 j6 h2 k5 g3 j5 i2 m6 g2 l5 f3 k8"},
+	};
+	int numpositions = sizeof(positions)/sizeof(positions[0]);
+
+	//the same seed for each search, so with one thread the numbers match from run to run
+	int oldthreads = player.numthreads;
+	uint32_t oldseed = player.seed;
+	bool oldprofile = player.profile;
+	bool p = player.ponder;
+	player.set_ponder(false);
+	player.profile = true;
+	if(player.seed == 0)
+		player.seed = 1;
+
+	string ret = "\n[\n";
+	for(int i = 0; i < numpositions; i++){
+		Board board(positions[i].size);
+		vecstr moves = explode(positions[i].moves, " ");
+		unsigned int nummoves = 0;
+		for(unsigned int m = 0; m < moves.size(); m++)
+			if(moves[m].size() && board.move(Move(moves[m])))
+				nummoves++;
+
+		for(int t = 1; t <= numthreads; t += max(numthreads - 1, 1)){
+			player.numthreads = t;
+			player.set_board(board); //resets the threads, so they start from the seed again
+			player.reclaim_wait();
+
+			PauseStats pauses = player.gcpauses, passes = player.gcpasses;
+			u64 freed = player.gcfreed;
+			player.runs = 0;
+
+			Player::Node * best = player.genmove(3600, runs, false);
+
+			double times[4] = {0,0,0,0};
+			for(unsigned int j = 0; j < player.threads.size(); j++)
+				for(int a = 0; a < 4; a++)
+					times[a] += player.threads[j]->times[a];
+
+			ret += string("{\"size\": ") + to_str(positions[i].size) + ", \"moves\": " + to_str(nummoves) +
+				", \"threads\": " + to_str(t) + ", \"runs\": " + to_str(player.runs) +
+				", \"msec\": " + to_str(player.time_used*1000, 0) + ", \"runs_per_sec\": " + to_str(player.runs/player.time_used, 0) +
+				", \"nodes\": " + to_str(player.nodes + player.gcfreed - freed) +
+				", \"gc\": " + to_str(player.gcpauses.num + player.gcpasses.num - pauses.num - passes.num) +
+				", \"gc_msec\": " + to_str(player.gcpauses.total + player.gcpasses.total - pauses.total - passes.total, 1) +
+				", \"stage_msec\": [" + to_str(times[0]*1000, 0) + ", " + to_str(times[1]*1000, 0) + ", " + to_str(times[2]*1000, 0) + ", " + to_str(times[3]*1000, 0) + "]" +
+				", \"move\": \"" + (best ? best->move.to_s() : string("resign")) + "\"" +
+				", \"root_sims\": " + to_str(player.root.exp.num()) + ", \"root_wins\": " + to_str(player.root.exp.sum()) + "}" +
+				(i + 1 < numpositions || t < numthreads ? "," : "") + "\n";
+
+			player.runs = 0;
+			player.proofs = 0;
+			player.proofattempts = 0;
+			if(t == numthreads)
+				break;
+		}
+	}
+	ret += "]";
+
+	player.numthreads = oldthreads;
+	player.seed = oldseed;
+	player.profile = oldprofile;
+	set_board(); //back to the game, with the old threads
+	player.set_ponder(p);
+
+	return GTPResponse(true, ret);
+}
+
+//fill and update each kind of weighted random the way the rollouts do
+static void bench_set(WeightedRandTree & w, int i, float g)    { w.set_weight_fast(i, g); }
+static void bench_set(WeightedRandBuckets & w, int i, float g) { w.set_weight(i, g); }
+static void bench_built(WeightedRandTree & w)    { w.rebuild_tree(); }
+static void bench_built(WeightedRandBuckets & w) { }
+
+//weighted random games from an empty board for len seconds, returns games/s
+template <class T> static double bench_wrand_games(const Board & start, const float * gammas, double len){
+	T w[2];
+	uint64_t games = 0;
+	Time starttime;
+	double elapsed;
+	do{
+		Board board = start;
+		w[0].resize(board.vecsize());
+		w[1].resize(board.vecsize());
+		for(Board::MoveIterator m = board.moveit(false, false); !m.done(); ++m){
+			int i = board.xy(*m);
+			bench_set(w[0], i, gammas[board.pattern(i)]);
+			bench_set(w[1], i, gammas[board.pattern_inv(i)]);
+		}
+		bench_built(w[0]);
+		bench_built(w[1]);
+
+		while(board.won() < 0){
+			int j = w[board.toplay()-1].choose();
+			if(j < 0)
+				break;
+			w[0].set_weight(j, 0);
+			w[1].set_weight(j, 0);
+			Move move = board.xymove(j);
+			board.move(move);
+			for(const MoveValid * i = board.nb_begin(move), *e = board.nb_end(i); i < e; i++){
+				if(i->onboard() && board.get(i->xy) == 0){
+					w[0].set_weight(i->xy, gammas[board.pattern(i->xy)]);
+					w[1].set_weight(i->xy, gammas[board.pattern_inv(i->xy)]);
+				}
+			}
+		}
+		games++;
+		elapsed = Time() - starttime;
+	}while(elapsed < len);
+	return games / elapsed;
+}
+
+GTPResponse HavannahGTP::gtp_bench_wrand(vecstr args){
+	double len = 0.5;
+	if(args.size() >= 1)
+		len = from_str<double>(args[0]);
+
+	//made up gammas spread over several powers of 10, like trained ones, the same for both
+	float gammas[4096];
+	XORShift_float rand(std::rand());
+	for(int i = 0; i < 4096; i++)
+		gammas[i] = pow(10.f, rand()*4 - 2);
+
+	string ret = "\n";
+	for(int size = 5; size <= 10; size++){
+		Board board(size);
+		double tree    = bench_wrand_games<WeightedRandTree>(board, gammas, len);
+		double buckets = bench_wrand_games<WeightedRandBuckets>(board, gammas, len);
+		ret += "size " + to_str(size) + ": tree " + to_str((uint64_t)tree) + " games/s, buckets " + to_str((uint64_t)buckets) +
+			" games/s, " + to_str(buckets/tree, 2) + "x\n";
+	}
+
+	return GTPResponse(true, ret);
+}
+
+GTPResponse HavannahGTP::gtp_check_bridge(vecstr args){
+	//every cell of a board, so every kind of edge and corner, with every mix of stones around it and both players in the middle,
+	//which is every pattern that can come up in a game
+	Player::PlayerUCT * thread = (Player::PlayerUCT *) player.threads[0];
+	Board empty(5);
+	uint64_t checked = 0;
+	int errors = 0;
+	for(Board::MoveIterator m = empty.moveit(false, false); !m.done(); ++m){
+		int center = empty.xy(*m);
+
+		vector<int> nbs; //the onboard neighbours, filled in every combination
+		for(const MoveValid * i = empty.nb_begin(center), *e = empty.nb_end(i); i < e; i++)
+			if(i->onboard())
+				nbs.push_back(i->xy);
+
+		vector<int> far; //where to put stones just to change who plays next, away from the pattern
+		for(Board::MoveIterator f = empty.moveit(false, false); !f.done(); ++f)
+			if(m->dist(*f) >= 2)
+				far.push_back(empty.xy(*f));
+
+		int combos = 1;
+		for(unsigned int i = 0; i < nbs.size(); i++)
+			combos *= 3;
+
+		for(int c = 0; c < combos; c++){
+			for(int probe = 1; probe <= 2; probe++){
+				Board board = empty;
+				unsigned int f = 0;
+				int code = c;
+				for(unsigned int i = 0; i <= nbs.size(); i++){
+					int xy = (i < nbs.size() ? nbs[i] : center);
+					int piece = (i < nbs.size() ? code % 3 : probe);
+					code /= 3;
+					if(piece == 0)
+						continue;
+					if(board.toplay() != piece)
+						board.set(board.xymove(far[f++]));
+					board.set(board.xymove(xy));
+				}
+				errors += thread->check_bridge(board, *m);
+				checked++;
+			}
+		}
+	}
+
+	return GTPResponse(errors == 0, to_str(checked) + " positions checked, " + to_str(errors) + " differences");
+}
+
+GTPResponse HavannahGTP::gtp_player_mem(vecstr args){
+	player.reclaim_wait(); //count the tree as it is, not the one being freed in the background
+
+	u64 maxmem = player.maxmem;
+	if(args.size() >= 1)
+		maxmem = from_str<u64>(args[0])*1024*1024;
+
+	//with a tree, count the Data headers and unused capacity it really has, otherwise assume one block of children per move on this board
+	double pernode = (double)CompactTree<Player::Node>::memsize(player.rootboard.movesremain()) / player.rootboard.movesremain();
+	if(player.nodes > 0)
+		pernode = (double)player.ctmem.meminuse() / player.nodes;
+
+	u64 treemem = maxmem - (u64)(maxmem*player.transpose);
+
+	return GTPResponse(true, to_str(sizeof(Player::Node)) + " bytes per node, " + to_str(pernode, 1) + " with overhead, " +
+		to_str((u64)(treemem/pernode)) + " nodes in " + to_str(maxmem/(1024*1024)) + " Mb, holding " + to_str(player.nodes) + " now");
+}
+
+GTPResponse HavannahGTP::gtp_player_gcstats(vecstr args){
+	if(args.size() >= 1 && args[0] == "reset"){
+		player.gcpauses.reset();
+		player.gcpasses.reset();
+		player.gcretained = 0;
+		player.gcrevisited = 0;
+		return GTPResponse(true);
+	}
+
+	return GTPResponse(true, "\nPauses with all threads stopped: " + player.gcpauses.to_s() +
+		"\nCollecting while searching:      " + player.gcpasses.to_s() +
+		"\nKept nodes walked through again: " + (player.gcretained ? to_str(100.0*player.gcrevisited/player.gcretained, 1) + "% of " + to_str(player.gcretained) : string("none")));
+}
+
 GTPResponse HavannahGTP::gtp_pv(vecstr args){
 	string pvstr = "";
 	vector<Move> pv = player.get_pv();
@@ -319,6 +637,7 @@ GTPResponse HavannahGTP::gtp_player_load_hgf(vecstr args){
 	eat_whitespace(fd);
 
 	Board board(size);
+	board.set_unique_depth(game.get_unique_depth());
 	Player::Node * node = & player.root;
 	vector<Player::Node *> prefix;
 
@@ -425,6 +744,7 @@ GTPResponse HavannahGTP::gtp_genmove(vecstr args){
 
 	DepthStats gamelen, treelen;
 	uint64_t runs = player.runs;
+	uword proofs = player.proofs, proofattempts = player.proofattempts;
 	uint64_t games = 0;
 	DepthStats wintypes[2][4];
 	double times[4] = {0,0,0,0};
@@ -445,11 +765,17 @@ GTPResponse HavannahGTP::gtp_genmove(vecstr args){
 		player.threads[i]->reset();
 	}
 	player.runs = 0;
+	player.proofs = 0;
+	player.proofattempts = 0;
 
 	string stats = "Finished " + to_str(runs) + " runs in " + to_str(player.time_used*1000, 0) + " msec: " + to_str(runs/player.time_used, 0) + " Games/s\n";
 	if(runs > 0){
 		stats += "Game length: " + gamelen.to_s() + "\n";
 		stats += "Tree depth:  " + treelen.to_s() + "\n";
+		if(player.tt.size())
+			stats += "Transpositions: " + to_str(player.tt.num()) + " positions, " + to_str(100.0*player.tt.num()/player.tt.size(), 1) + "% full\n";
+		if(player.provers)
+			stats += "Provers:     " + to_str(proofs) + " proofs in " + to_str(proofattempts) + " attempts\n";
 		if(player.profile)
 			stats += "Times:       " + to_str(times[0], 3) + ", " + to_str(times[1], 3) + ", " + to_str(times[2], 3) + ", " + to_str(times[3], 3) + "\n";
 		stats += "Win Types:   ";
@@ -521,10 +847,14 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			"Processing:\n" +
 #ifndef SINGLE_THREAD
 			"  -t --threads     Number of MCTS threads                            [" + to_str(player.numthreads) + "]\n" +
+			"     --leafpar     Helper threads per thread to share its rollouts   [" + to_str(player.leafpar) + "]\n" +
+			"  -j --rootpar     Separate trees shared by the threads, 0 for one   [" + to_str(player.rootpar) + "]\n" +
+			"     --rootsync    Merge the separate trees every this many msec     [" + to_str(player.rootsync) + "]\n" +
 #endif
 			"  -o --ponder      Continue to ponder during the opponents time      [" + to_str(player.ponder) + "]\n" +
 			"  -M --maxmem      Max memory in Mb to use for the tree              [" + to_str(player.maxmem/(1024*1024)) + "]\n" +
 			"     --profile     Output the time used by each phase of MCTS        [" + to_str(player.profile) + "]\n" +
+			"     --seed        Seed the threads' random numbers, 0 for the clock [" + to_str(player.seed) + "]\n" +
 			"Final move selection:\n" +
 			"  -E --msexplore   Lower bound constant in final move selection      [" + to_str(player.msexplore) + "]\n" +
 			"  -F --msrave      Rave factor, 0 for pure exp, -1 # sims, -2 # wins [" + to_str(player.msrave) + "]\n" +
@@ -543,11 +873,19 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			"  -s --shortrave   Only use moves from short rollouts for rave       [" + to_str(player.shortrave) + "]\n" +
 			"  -k --keeptree    Keep the tree from the previous move              [" + to_str(player.keeptree) + "]\n" +
 			"  -m --minimax     Backup the minimax proof in the UCT tree          [" + to_str(player.minimax) + "]\n" +
+#ifndef SINGLE_THREAD
+			"     --provers     Threads proving heavy nodes with PNS, for minimax [" + to_str(player.provers) + "]\n" +
+			"     --provemin    Sims a node needs before the provers try it       [" + to_str(player.provemin) + "]\n" +
+			"     --provemem    Max memory in Mb for each prover's attempt        [" + to_str(player.provemem) + "]\n" +
+#endif
 			"  -T --detectdraw  Detect draws once no win is possible at all       [" + to_str(player.detectdraw) + "]\n" +
 			"  -x --visitexpand Number of visits before expanding a node          [" + to_str(player.visitexpand) + "]\n" +
 			"  -P --symmetry    Prune symmetric moves, good for proof, not play   [" + to_str(player.prunesymmetry) + "]\n" +
 			"  -L --logproof    Log proven nodes hashes and outcomes to this file [" + player.solved_logname + "]\n" +
 			"     --gcsolved    Garbage collect solved nodes with fewer sims than [" + to_str(player.gcsolved) + "]\n" +
+			"     --gcconc      Collect while searching past this part of maxmem  [" + to_str(player.gcconcurrent) + "]\n" +
+			"     --gcdecay     Discount sims per GC a subtree is left unvisited  [" + to_str(player.gcdecay) + "]\n" +
+			"  -U --transpose   Share position stats in this fraction of maxmem   [" + to_str(player.transpose) + "]\n" +
 			"Node initialization knowledge, Give a bonus:\n" +
 			"  -l --localreply     based on the distance to the previous move     [" + to_str(player.localreply) + "]\n" +
 			"  -y --locality       to stones near other stones of the same color  [" + to_str(player.locality) + "]\n" +
@@ -578,12 +916,45 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			player.set_ponder(false); //stop the threads while resetting them
 			player.reset_threads();
 			player.set_ponder(p);
+		}else if((               arg == "--leafpar") && i+1 < args.size()){
+			player.leafpar = from_str<int>(args[++i]);
+			bool p = player.ponder;
+			player.set_ponder(false); //stop the threads while resetting them
+			player.reset_threads();
+			player.set_ponder(p);
+		}else if((               arg == "--provers" || arg == "--provemem") && i+1 < args.size()){
+			if(arg == "--provers")
+				player.provers = from_str<int>(args[++i]);
+			else
+				player.provemem = from_str<uint>(args[++i]);
+			bool p = player.ponder;
+			player.set_ponder(false); //stop the threads while resetting them
+			player.reset_threads();
+			player.set_ponder(p);
+		}else if((               arg == "--provemin") && i+1 < args.size()){
+			player.provemin = from_str<uint>(args[++i]);
+		}else if((arg == "-j" || arg == "--rootpar") && i+1 < args.size()){
+			int r = from_str<int>(args[++i]);
+			if(r < 0)
+				errs += "The number of separate trees can't be negative\n";
+			else
+				player.set_rootpar(r);
+		}else if((               arg == "--rootsync") && i+1 < args.size()){
+			player.rootsync = from_str<uint>(args[++i]);
 		}else if((arg == "-o" || arg == "--ponder") && i+1 < args.size()){
 			player.set_ponder(from_str<bool>(args[++i]));
 		}else if((arg == "--profile") && i+1 < args.size()){
 			player.profile = from_str<bool>(args[++i]);
+		}else if((arg == "--seed") && i+1 < args.size()){
+			player.seed = from_str<uint32_t>(args[++i]);
+			bool p = player.ponder;
+			player.set_ponder(false); //stop the threads while reseeding them
+			player.reset_threads();
+			player.set_ponder(p);
 		}else if((arg == "-M" || arg == "--maxmem") && i+1 < args.size()){
 			player.maxmem = from_str<uint64_t>(args[++i])*1024*1024;
+			if(player.transpose > 0)
+				player.set_transpose(player.transpose); //resize the table to match
 		}else if((arg == "-E" || arg == "--msexplore") && i+1 < args.size()){
 			player.msexplore = from_str<float>(args[++i]);
 		}else if((arg == "-F" || arg == "--msrave") && i+1 < args.size()){
@@ -613,6 +984,24 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 				errs += "Can't set the log file\n";
 		}else if((               arg == "--gcsolved") && i+1 < args.size()){
 			player.gcsolved = from_str<uint>(args[++i]);
+		}else if((               arg == "--gcconc") && i+1 < args.size()){
+			float g = from_str<float>(args[++i]);
+			if(g < 0 || g >= 1)
+				errs += "Collecting while searching must start at a fraction of maxmem, in [0,1), 0 to disable\n";
+			else
+				player.gcconcurrent = g;
+		}else if((               arg == "--gcdecay") && i+1 < args.size()){
+			float g = from_str<float>(args[++i]);
+			if(g <= 0 || g > 1)
+				errs += "The decay per collection must be in (0,1], 1 to collect by experience alone\n";
+			else
+				player.gcdecay = g;
+		}else if((arg == "-U" || arg == "--transpose") && i+1 < args.size()){
+			float t = from_str<float>(args[++i]);
+			if(t < 0 || t >= 1)
+				errs += "The transposition table must be a fraction of maxmem, in [0,1)\n";
+			else
+				player.set_transpose(t);
 		}else if((arg == "-r" || arg == "--userave") && i+1 < args.size()){
 			player.userave = from_str<float>(args[++i]);
 		}else if((arg == "-X" || arg == "--useexplore") && i+1 < args.size()){
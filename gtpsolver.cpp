@@ -22,6 +22,20 @@ string HavannahGTP::solve_str(const Solver & solve){
 	return ret;
 }
 
+string HavannahGTP::solve_time_str(const Solver & solve) const {
+	string ret = "Finished in " + to_str(solve.time_used*1000, 0) + " msec";
+	if(solve.time_used > 0)
+		ret += ", " + to_str((uint64_t)(solve.nodes_seen/solve.time_used)) + " nodes/s";
+	return ret + "\n";
+}
+
+string HavannahGTP::tt_str(uint64_t hits, uint64_t probes) const {
+	string ret = "TT hits: " + to_str(hits) + " of " + to_str(probes);
+	if(probes)
+		ret += ", " + to_str(100.0*hits/probes, 1) + "%";
+	return ret + "\n";
+}
+
 
 
 
@@ -33,7 +47,8 @@ GTPResponse HavannahGTP::gtp_solve_ab(vecstr args){
 
 	solverab.solve(time);
 
-	logerr("Finished in " + to_str(solverab.time_used*1000, 0) + " msec\n");
+	logerr(solve_time_str(solverab));
+	logerr(tt_str(solverab.tt_hits, solverab.tt_probes));
 
 	return GTPResponse(true, solve_str(solverab));
 }
@@ -96,7 +111,7 @@ GTPResponse HavannahGTP::gtp_solve_pns(vecstr args){
 
 	solverpns.solve(time);
 
-	logerr("Finished in " + to_str(solverpns.time_used*1000, 0) + " msec\n");
+	logerr(solve_time_str(solverpns));
 
 	return GTPResponse(true, solve_str(solverpns));
 }
@@ -183,7 +198,7 @@ GTPResponse HavannahGTP::gtp_solve_pns2(vecstr args){
 
 	solverpns2.solve(time);
 
-	logerr("Finished in " + to_str(solverpns2.time_used*1000, 0) + " msec\n");
+	logerr(solve_time_str(solverpns2));
 
 	return GTPResponse(true, solve_str(solverpns2));
 }
@@ -275,7 +290,8 @@ GTPResponse HavannahGTP::gtp_solve_pnstt(vecstr args){
 
 	solverpnstt.solve(time);
 
-	logerr("Finished in " + to_str(solverpnstt.time_used*1000, 0) + " msec\n");
+	logerr(solve_time_str(solverpnstt));
+	logerr(tt_str(solverpnstt.tt_hits, solverpnstt.tt_probes));
 
 	return GTPResponse(true, solve_str(solverpnstt));
 }
@@ -91,10 +91,13 @@ public:
 		newcallback("print",           bind(&HavannahGTP::gtp_print,         this, _1), "Alias for showboard");
 		newcallback("dists",           bind(&HavannahGTP::gtp_dists,         this, _1), "Similar to print, but shows minimum win distances");
 		newcallback("zobrist",         bind(&HavannahGTP::gtp_zobrist,       this, _1), "Output the zobrist hash for the current move");
+		newcallback("bench_board",     bind(&HavannahGTP::gtp_bench_board,   this, _1), "Time random games on an empty board: bench_board [size] [seconds]");
+		newcallback("bench_rings",     bind(&HavannahGTP::gtp_bench_rings,   this, _1), "Time random games from this position that check for rings: bench_rings [seconds] [minringsize] [ringperm]");
 		newcallback("clear_board",     bind(&HavannahGTP::gtp_clearboard,    this, _1), "Clear the board, but keep the size");
 		newcallback("clear",           bind(&HavannahGTP::gtp_clearboard,    this, _1), "Alias for clear_board");
 		newcallback("boardsize",       bind(&HavannahGTP::gtp_boardsize,     this, _1), "Clear the board, set the board size");
 		newcallback("swap",            bind(&HavannahGTP::gtp_swap,          this, _1), "Enable/disable swap: swap <0|1>");
+		newcallback("unique_depth",    bind(&HavannahGTP::gtp_unique_depth,  this, _1), "Hash and prune symmetric positions up to this many moves deep: unique_depth [depth]");
 		newcallback("play",            bind(&HavannahGTP::gtp_play,          this, _1), "Place a stone: play <color> <location>");
 		newcallback("white",           bind(&HavannahGTP::gtp_playwhite,     this, _1), "Place a white stone: white <location>");
 		newcallback("black",           bind(&HavannahGTP::gtp_playblack,     this, _1), "Place a black stone: black <location>");
@@ -103,6 +106,13 @@ public:
 		newcallback("move_stats",      bind(&HavannahGTP::gtp_move_stats,    this, _1), "Output the move stats for the player tree as it stands now");
 		newcallback("player_solve",    bind(&HavannahGTP::gtp_player_solve,  this, _1), "Run the player, but don't make the move, and give solve output");
 		newcallback("player_solved",   bind(&HavannahGTP::gtp_player_solved, this, _1), "Output whether the player solved the current node");
+		newcallback("player_stress",   bind(&HavannahGTP::gtp_player_stress, this, _1), "Search with many threads, then check the tree: player_stress [threads] [seconds]");
+		newcallback("player_gcstats",  bind(&HavannahGTP::gtp_player_gcstats, this, _1), "Histograms of garbage collection times: player_gcstats [reset]");
+		newcallback("player_mem",      bind(&HavannahGTP::gtp_player_mem, this, _1), "Bytes per node and how many nodes fit in maxmem: player_mem [maxmem in Mb]");
+		newcallback("bench_choose",    bind(&HavannahGTP::gtp_bench_choose, this, _1), "Time choosing a child with and without simd: bench_choose [seconds]");
+		newcallback("bench_wrand",     bind(&HavannahGTP::gtp_bench_wrand,   this, _1), "Time weighted random games with the tree and the buckets: bench_wrand [seconds per size]");
+		newcallback("check_bridge",    bind(&HavannahGTP::gtp_check_bridge,  this, _1), "Check the bridge reply tables against the scans they replace, for every pattern");
+		newcallback("benchmark",       bind(&HavannahGTP::gtp_benchmark,     this, _1), "Search fixed positions with fixed seeds, output JSON: benchmark [runs] [threads]");
 		newcallback("player_hgf",      bind(&HavannahGTP::gtp_player_hgf,    this, _1), "Output an hgf of the current tree");
 		newcallback("player_load_hgf", bind(&HavannahGTP::gtp_player_load_hgf,this, _1), "Load an hgf generated by player_hgf");
 		newcallback("player_confirm",  bind(&HavannahGTP::gtp_confirm_proof, this, _1), "Confirm the outcome of the current tree, for use after loading a proof tree");
@@ -160,6 +170,7 @@ public:
 	GTPResponse gtp_zobrist(vecstr args);
 	string won_str(int outcome) const;
 	GTPResponse gtp_swap(vecstr args);
+	GTPResponse gtp_unique_depth(vecstr args);
 	GTPResponse gtp_boardsize(vecstr args);
 	GTPResponse gtp_clearboard(vecstr args);
 	GTPResponse gtp_undo(vecstr args);
@@ -184,12 +195,21 @@ public:
 	GTPResponse gtp_gridcoords(vecstr args);
 	GTPResponse gtp_debug(vecstr args);
 	GTPResponse gtp_dists(vecstr args);
+	GTPResponse gtp_bench_board(vecstr args);
+	GTPResponse gtp_bench_rings(vecstr args);
 
 	GTPResponse gtp_time(vecstr args);
 	double get_time();
 	GTPResponse gtp_move_stats(vecstr args);
 	GTPResponse gtp_player_solve(vecstr args);
 	GTPResponse gtp_player_solved(vecstr args);
+	GTPResponse gtp_player_stress(vecstr args);
+	GTPResponse gtp_bench_choose(vecstr args);
+	GTPResponse gtp_benchmark(vecstr args);
+	GTPResponse gtp_check_bridge(vecstr args);
+	GTPResponse gtp_bench_wrand(vecstr args);
+	GTPResponse gtp_player_mem(vecstr args);
+	GTPResponse gtp_player_gcstats(vecstr args);
 	GTPResponse gtp_pv(vecstr args);
 	GTPResponse gtp_genmove(vecstr args);
 	GTPResponse gtp_player_params(vecstr args);
@@ -200,6 +220,8 @@ public:
 
 	string solve_str(int outcome) const;
 	string solve_str(const Solver & solve);
+	string solve_time_str(const Solver & solve) const;
+	string tt_str(uint64_t hits, uint64_t probes) const;
 
 	GTPResponse gtp_solve_ab(vecstr args);
 	GTPResponse gtp_solve_ab_params(vecstr args);
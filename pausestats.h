@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "string.h"
+using namespace std;
+
+//a histogram of pause lengths, in buckets by powers of 2 msec, from under 1 msec up to 4 seconds or more
+struct PauseStats {
+	static const int buckets = 14;
+	uint32_t num;
+	uint32_t counts[buckets];
+	double total, longest; //in msec
+
+	PauseStats(){
+		reset();
+	}
+	void reset(){
+		num = 0;
+		for(int i = 0; i < buckets; i++)
+			counts[i] = 0;
+		total = 0;
+		longest = 0;
+	}
+
+	void add(double sec){
+		double msec = sec*1000;
+		int b = 0;
+		while(b < buckets - 1 && msec >= (1 << b))
+			b++;
+		counts[b]++;
+		num++;
+		total += msec;
+		if(longest < msec)
+			longest = msec;
+	}
+
+	double avg() const {
+		if(num == 0) return 0.0;
+		return total/num;
+	}
+	string to_s() const {
+		if(num == 0) return "num=0";
+		string s = "num=" + to_str(num) + ", avg=" + to_str(avg(), 1) + ", max=" + to_str(longest, 1) + " msec:";
+		for(int i = 0; i < buckets; i++)
+			if(counts[i])
+				s += (i == buckets - 1 ? " >=" + to_str(1 << (i-1)) : " <" + to_str(1 << i)) + ":" + to_str(counts[i]);
+		return s;
+	}
+};
+
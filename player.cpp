@@ -7,6 +7,7 @@
 #include "alarm.h"
 #include "time.h"
 #include "fileio.h"
+#include <sched.h>
 
 const float Player::min_rave = 0.1;
 
@@ -34,34 +35,69 @@ void Player::PlayerThread::run(){
 					logerr("Solved as " + to_str(player->root.outcome) + "\n");
 				break;
 			}
-			if(player->ctmem.memalloced() >= player->maxmem){ //out of memory, start garbage collection
-				CAS(player->threadstate, Thread_Running, Thread_GC);
+			if(player->ctmem.memalloced() + player->tt.memsize() >= player->maxmem || player->tt.full()){ //out of memory, start garbage collection
+				if(CAS(player->threadstate, Thread_Running, Thread_GC))
+					player->interrupt();
+				break;
+			}
+			if(player->gcconcurrent > 0 && player->reclaiming == 0 &&
+				player->ctmem.meminuse() >= (player->maxmem - player->tt.memsize())*player->gcconcurrent &&
+				CAS(player->gcing, 0, 1)){ //running low on memory, collect while the others keep searching
+				player->collect_concurrent();
+				player->gcing = 0;
 				break;
 			}
 
-			INCR(player->runs);
+			//announce the epoch before reading the tree, so the collector waits for this iteration before freeing what it cut
+			epoch = player->gcepoch;
+			__sync_synchronize();
 			iterate();
+			__sync_lock_release(&epoch);
 			break;
 
 		case Thread_GC:         //one thread is running garbage collection, the rest are waiting
 		case Thread_GC_End:     //once done garbage collecting, go to wait_end instead of back to running
 			if(player->gcbarrier.wait()){
 				Time starttime;
-				logerr("Starting player GC with limit " + to_str(player->gclimit) + " ... ");
 				uint64_t nodesbefore = player->nodes;
-				Board copy = player->rootboard;
-				player->garbage_collect(copy, & player->root);
-				player->flushlog();
+
+				//if collecting while searching keeps the tree small, the memory is just fragmented, so only compact it
+				bool collect = (player->gcconcurrent <= 0 || player->tt.full() ||
+					player->ctmem.meminuse() >= (player->maxmem - player->tt.memsize())*player->gcconcurrent);
+				if(collect){
+					logerr("Starting player GC with limit " + to_str(player->gclimit) + " ... ");
+					player->gcretained += player->gckept;
+					Board copy = player->rootboard;
+					player->garbage_collect(copy, & player->root);
+					for(unsigned int i = 0; i < player->roots.size(); i++){
+						copy = player->rootboard;
+						player->garbage_collect(copy, & player->roots[i]);
+					}
+					player->flushlog();
+					player->ctmem.next_gen();
+					player->gckept = player->nodes;
+				}else{
+					logerr("Starting player compaction ... ");
+				}
+				uword ttbefore = player->tt.num();
+				if(collect)
+					player->tt.gc(player->gclimit, player->rootboard.num_moves());
 				Time gctime;
+				player->reclaimlock.lock();
 				player->ctmem.compact(1.0, 0.75);
+				player->reclaimlock.unlock();
 				Time compacttime;
+				player->gcpauses.add(compacttime - starttime);
 				logerr(to_str(100.0*player->nodes/nodesbefore, 1) + " % of tree remains - " +
+					(ttbefore ? to_str(100.0*player->tt.num()/ttbefore, 1) + " % of transpositions remain - " : string()) +
 					to_str((gctime - starttime)*1000, 0)  + " msec gc, " + to_str((compacttime - gctime)*1000, 0) + " msec compact\n");
 
-				if(player->ctmem.meminuse() >= player->maxmem/2)
-					player->gclimit = (int)(player->gclimit*1.3);
-				else if(player->gclimit > player->rollouts*5)
-					player->gclimit = (int)(player->gclimit*0.9); //slowly decay to a minimum of 5
+				if(collect){
+					if(player->ctmem.meminuse() >= (player->maxmem - player->tt.memsize())/2 || player->tt.num() > player->tt.size()/2)
+						player->gclimit = (int)(player->gclimit*1.3);
+					else if(player->gclimit > player->rollouts*5)
+						player->gclimit = (int)(player->gclimit*0.9); //slowly decay to a minimum of 5
+				}
 
 				CAS(player->threadstate, Thread_GC,     Thread_Running);
 				CAS(player->threadstate, Thread_GC_End, Thread_Wait_End);
@@ -106,6 +142,9 @@ Player::Node * Player::genmove(double time, int max_runs, bool flexible){
 		assert(threadstate == Thread_Wait_Start);
 	}
 
+	if(roots.size())
+		merge_roots();
+
 	if(ponder && root.outcome < 0)
 		start_threads();
 
@@ -120,14 +159,30 @@ Player::Node * Player::genmove(double time, int max_runs, bool flexible){
 Player::Player() {
 	nodes = 0;
 	gclimit = 5;
+	gcepoch = 1;
+	gcing = 0;
+	gcfreed = 0;
+	gckept = 0;
+	gcretained = 0;
+	gcrevisited = 0;
+	proofs = 0;
+	proofattempts = 0;
+	reclaiming = 0;
+	reclaimed = 0;
+	reclaimexit = false;
 	time_used = 0;
 
 	solved_logfile = NULL;
 
 	profile     = false;
+	seed        = 0;
+	seeds       = 0;
 	ponder      = false;
 //#ifdef SINGLE_THREAD ... make sure only 1 thread
 	numthreads  = 1;
+	leafpar     = 0;
+	rootpar     = 0;
+	rootsync    = 0;
 	maxmem      = 1000*1024*1024;
 
 	msrave      = -2;
@@ -151,6 +206,12 @@ Player::Player() {
 	visitexpand = 1;
 	prunesymmetry = false;
 	gcsolved    = 100000;
+	gcconcurrent = 0.8;
+	gcdecay     = 0.5;
+	provers     = 0;
+	provemin    = 1000;
+	provemem    = 16;
+	transpose   = 0;
 
 	localreply  = 0;
 	locality    = 0;
@@ -173,15 +234,27 @@ Player::Player() {
 	for(int i = 0; i < 4096; i++)
 		gammas[i] = 1;
 
+	set_bridge_tables();
+
 	//no threads started until a board is set
 	threadstate = Thread_Wait_Start;
+
+	reclaimer(std::tr1::bind(&Player::reclaim_run, this));
 }
 Player::~Player(){
 	stop_threads();
 
 	numthreads = 0;
+	provers = 0;
 	reset_threads(); //shut down the theads properly
 
+	//finish what was retired, then shut down the reclaimer
+	reclaimcond.lock();
+	reclaimexit = true;
+	reclaimcond.broadcast();
+	reclaimcond.unlock();
+	reclaimer.join();
+
 	if(solved_logfile){
 		logsolved(rootboard, & root);
 		fclose(solved_logfile);
@@ -189,11 +262,19 @@ Player::~Player(){
 	}
 
 	root.dealloc(ctmem);
+	for(unsigned int i = 0; i < roots.size(); i++)
+		roots[i].dealloc(ctmem);
 	ctmem.compact();
 }
 void Player::timedout() {
 	CAS(threadstate, Thread_Running, Thread_Wait_End);
 	CAS(threadstate, Thread_GC, Thread_GC_End);
+	interrupt();
+}
+
+void Player::interrupt() {
+	for(unsigned int i = 0; i < threads.size(); i++)
+		threads[i]->stop();
 }
 
 string Player::statestring(){
@@ -232,19 +313,24 @@ void Player::reset_threads(){ //start and end with threadstate = Thread_Wait_Sta
 	runbarrier.wait();
 
 //make sure they exited cleanly
-	for(unsigned int i = 0; i < threads.size(); i++)
+	for(unsigned int i = 0; i < threads.size(); i++){
 		threads[i]->join();
+		delete threads[i];
+	}
 
 	threads.clear();
 
 	threadstate = Thread_Wait_Start;
 
-	runbarrier.reset(numthreads + 1);
-	gcbarrier.reset(numthreads);
+	seeds = 0;
+	runbarrier.reset(numthreads + provers + 1);
+	gcbarrier.reset(numthreads + provers);
 
 //start new threads
 	for(int i = 0; i < numthreads; i++)
-		threads.push_back(new PlayerUCT(this));
+		threads.push_back(new PlayerUCT(this, i));
+	for(int i = 0; i < provers; i++)
+		threads.push_back(new PlayerProver(this, i));
 }
 
 void Player::set_ponder(bool p){
@@ -260,27 +346,82 @@ void Player::set_ponder(bool p){
 void Player::set_board(const Board & board){
 	stop_threads();
 
-	logsolved(rootboard, & root);
-	nodes -= root.dealloc(ctmem);
+	retire(root, true);
 	root = Node();
 	root.exp.addwins(visitexpand+1);
 
 	rootboard = board;
+	gckept = 0;
+
+	tt.clear();
+	reset_roots();
+	reclaim();
 
 	reset_threads(); //needed since the threads aren't started before a board it set
 
 	if(ponder)
 		start_threads();
 }
+void Player::set_rootpar(int r){
+	stop_threads();
+
+	//the shared tree is only used for the merged root children from here on, or needs to be regrown from them
+	retire(root, false);
+	rootpar = r;
+	reset_roots();
+	reclaim();
+
+	if(ponder)
+		start_threads();
+}
+
+void Player::set_transpose(float t){
+	stop_threads();
+
+	transpose = t;
+	tt.alloc(transpose > 0 ? (u64)(maxmem*transpose) : 0);
+
+	if(ponder)
+		start_threads();
+}
+
 void Player::move(const Move & m){
+	Time starttime;
 	stop_threads();
 
-	uword nodesbefore = nodes;
+	uword nodesbefore = nodes, reclaimedbefore = reclaimed;
+	bool kept = (keeptree && root.children.num() > 0);
+
+	move_root(root, m, true);
+	for(unsigned int i = 0; i < roots.size(); i++)
+		move_root(roots[i], m, false);
 
-	if(keeptree && root.children.num() > 0){
+	rootboard.move(m, true, true);
+
+	root.exp.addwins(visitexpand+1); //+1 to compensate for the virtual loss
+	if(rootboard.won() < 0)
+		root.outcome = -3;
+
+	for(unsigned int i = 0; i < roots.size(); i++){
+		roots[i].exp.addwins(visitexpand+1);
+		if(rootboard.won() < 0)
+			roots[i].outcome = -3;
+	}
+	if(roots.size())
+		merge_roots(); //from the subtrees they kept
+
+	if(ponder)
+		start_threads();
+
+	//the reclaimer reports how much was kept once it knows how much it freed
+	reclaim((kept ? nodesbefore : 0), reclaimedbefore, Time() - starttime);
+}
+
+void Player::move_root(Node & node, const Move & m, bool log){
+	if(keeptree && node.children.num() > 0){
 		Node child;
 
-		for(Node * i = root.children.begin(); i != root.children.end(); i++){
+		for(Node * i = node.children.begin(); i != node.children.end(); i++){
 			if(i->move == m){
 				child = *i;          //copy the child experience to temp
 				child.swap_tree(*i); //move the child tree to temp
@@ -288,29 +429,104 @@ void Player::move(const Move & m){
 			}
 		}
 
-		logsolved(rootboard, &root);
-		nodes -= root.dealloc(ctmem);
-		root = child;
-		root.swap_tree(child);
-
-		if(nodesbefore > 0)
-			logerr("Nodes before: " + to_str(nodesbefore) + ", after: " + to_str(nodes) + ", saved " +  to_str(100.0*nodes/nodesbefore, 1) + "% of the tree\n");
+		retire(node, log);
+		node = child;
+		node.swap_tree(child);
 	}else{
-		logsolved(rootboard, &root);
-		nodes -= root.dealloc(ctmem);
-		root = Node();
-		root.move = m;
+		retire(node, log);
+		node = Node();
+		node.move = m;
 	}
-	assert(nodes == root.size());
+}
 
-	rootboard.move(m, true, true);
+//detach the subtree in constant time, to be freed by the reclaimer, optionally logging its solved nodes first
+void Player::retire(Node & node, bool log){
+	log = (log && solved_logfile);
 
-	root.exp.addwins(visitexpand+1); //+1 to compensate for the virtual loss
-	if(rootboard.won() < 0)
-		root.outcome = -3;
+	Node * n = new Node(node); //the stats, for logging
+	if(!node.children.detach(n->children)){ //nothing to free
+		if(log)
+			logsolved(rootboard, n);
+		delete n;
+		return;
+	}
 
-	if(ponder)
-		start_threads();
+	Retired r;
+	r.node = n;
+	r.log = log;
+	if(log)
+		r.board = rootboard;
+	r.report = 0;
+	retired.push_back(r);
+}
+
+//hand the retired subtrees to the reclaimer, which logs the before/after of a move once they're all freed
+void Player::reclaim(uword nodesbefore, uword reclaimedbefore, double ready){
+	if(retired.empty())
+		return;
+
+	retired.back().report = nodesbefore;
+	retired.back().reclaimed = reclaimedbefore;
+	retired.back().ready = ready;
+	retired.back().queued = Time();
+
+	PLUS(reclaiming, retired.size());
+	reclaimcond.lock();
+	reclaimq.insert(reclaimq.end(), retired.begin(), retired.end());
+	reclaimcond.signal();
+	reclaimcond.unlock();
+	retired.clear();
+}
+
+void Player::reclaim_run(){
+	while(true){
+		reclaimcond.lock();
+		while(reclaimq.empty() && !reclaimexit)
+			reclaimcond.wait();
+		if(reclaimq.empty()){ //exiting, and everything is freed
+			reclaimcond.unlock();
+			return;
+		}
+		Retired r = reclaimq.front();
+		reclaimq.erase(reclaimq.begin());
+		reclaimcond.unlock();
+
+		//hold off compaction, it moves the blocks being freed
+		reclaimlock.lock();
+		if(r.log){
+			logsolved_unsafe(r.board, r.node, false);
+			flushlog();
+		}
+		uword freed = reclaim_free(r.node);
+		reclaimlock.unlock();
+
+		reclaimed += freed;
+		delete r.node;
+
+		if(r.report){ //everything in the tree before the move that was freed since then wasn't kept
+			uword after = r.report - (reclaimed - r.reclaimed);
+			logerr("Nodes before: " + to_str(r.report) + ", after: " + to_str(after) + ", saved " +  to_str(100.0*after/r.report, 1) + "% of the tree, " +
+				to_str(r.ready*1000, 0) + " msec to first iteration, " + to_str((Time() - r.queued)*1000, 0) + " msec to free the rest in the background\n");
+		}
+
+		PLUS(reclaiming, -1);
+	}
+}
+
+//like Node::dealloc, but nodes goes down with each block freed, so it stays in step with ctmem.meminuse() for the stats
+uword Player::reclaim_free(Node * node){
+	uword freed = 0;
+	if(node->children.num())
+		for(Node * i = node->children.begin(); i != node->children.end(); i++)
+			freed += reclaim_free(i);
+	uword n = node->children.dealloc(ctmem);
+	PLUS(nodes, -n);
+	return freed + n;
+}
+
+void Player::reclaim_wait(){
+	while(reclaiming > 0)
+		sched_yield();
 }
 
 double Player::gamelen(){
@@ -362,6 +578,73 @@ void Player::logsolved_unsafe(Board & board, const Node * node, bool skiproot){
 	}
 }
 
+void Player::reset_roots(){
+	for(unsigned int i = 0; i < roots.size(); i++)
+		retire(roots[i], false);
+	roots.clear();
+
+	roots.resize(rootpar);
+	for(unsigned int i = 0; i < roots.size(); i++)
+		roots[i].exp.addwins(visitexpand+1);
+
+	lastsync = Time();
+	syncing = 0;
+}
+
+//sum the root children of the separate trees into the shared root, so return_move, the pv and move_stats see them all
+//proofs found in one tree are shared with the others, but the experience below the root isn't
+void Player::merge_roots(){
+	if(root.children.empty()){
+		//take the moves of the first tree to expand its root, they all expand to the same moves, including macro moves
+		Node * src = NULL;
+		for(unsigned int i = 0; i < roots.size() && !src; i++)
+			if(roots[i].children.num())
+				src = & roots[i];
+		if(!src)
+			return;
+
+		root.alloc(src->children.num(), ctmem);
+		for(Node * child = root.children.begin(), * c = src->children.begin(); child != root.children.end(); child++, c++)
+			*child = Node(c->move);
+		PLUS(nodes, root.children.num());
+	}
+
+	ExpPair rootexp;
+	for(unsigned int i = 0; i < roots.size(); i++)
+		rootexp += roots[i].exp;
+	root.exp = rootexp;
+
+	for(Node * child = root.children.begin(), * end = root.children.end(); child != end; child++){
+		ExpPair exp, rave;
+		for(unsigned int i = 0; i < roots.size(); i++){
+			Node * c = roots[i].children.find(child->move);
+			if(!c)
+				continue;
+
+			exp += c->exp;
+			rave += c->rave;
+
+			ProofWord proof = get_proof(c);
+			int childoutcome = child->outcome;
+			if(proof.p.outcome >= 0 && childoutcome < 0)
+				set_outcome(child, childoutcome, proof.p.outcome, proof.p.proofdepth, Move(proof.p.x, proof.p.y));
+		}
+		child->exp = exp;
+		child->rave = rave;
+
+		ProofWord proof = get_proof(child);
+		if(proof.p.outcome < 0)
+			continue;
+
+		for(unsigned int i = 0; i < roots.size(); i++){
+			Node * c = roots[i].children.find(child->move);
+			int childoutcome = (c ? c->outcome : 0);
+			if(c && childoutcome < 0)
+				set_outcome(c, childoutcome, proof.p.outcome, proof.p.proofdepth, Move(proof.p.x, proof.p.y));
+		}
+	}
+}
+
 vector<Move> Player::get_pv(){
 	vector<Move> pv;
 
@@ -423,27 +706,98 @@ Player::Node * Player::return_move(Node * node, int toplay) const {
 	return ret;
 }
 
-void Player::garbage_collect(Board & board, Node * node){
-	Node * child = node->children.begin(),
-		 * end = node->children.end();
+//unsolved nodes are kept by their experience, discounted by gcdecay for each collection since they were last walked through
+//a subtree that wasn't walked through since the last collection hasn't changed since then, so it's kept or cut whole
+void Player::garbage_collect(Board & board, Node * node, vector<Node *> * cut){
+	Node * end, * child = node->children.range(end); //other threads may be creating children while collecting concurrently
 
+	uint16_t gen = ctmem.gen();
 	int toplay = board.toplay();
 	for( ; child != end; child++){
 		if(child->children.num() == 0)
 			continue;
 
+		uint16_t age = child->children.age(gen);
+		if(age == 0 && child->children.older(gen)) //kept by the last collection and walked through since
+			gcrevisited += child->children.num();
+		bool recent = (age == 0 || gcdecay >= 1);
+
 		if(	(node->outcome >= 0 && child->exp.num() > gcsolved && (node->outcome != toplay || child->outcome == toplay || child->outcome == 0)) || //parent is solved, only keep the proof tree, plus heavy draws
-			(node->outcome <  0 && child->exp.num() > (child->outcome >= 0 ? gcsolved : gclimit)) ){ // only keep heavy nodes, with different cutoffs for solved and unsolved
-			board.set(child->move);
-			garbage_collect(board, child);
-			board.unset(child->move);
+			(node->outcome <  0 && (child->outcome >= 0 ? child->exp.num() > gcsolved : // only keep heavy nodes, with different cutoffs for solved and unsolved
+				child->exp.num()*(recent ? 1.0 : pow(gcdecay, age)) > gclimit)) ){
+			if(recent){
+				board.set(child->move);
+				garbage_collect(board, child, cut);
+				board.unset(child->move);
+			}
 		}else{
 			if(solved_logfile){
 				board.set(child->move);
 				logsolved_unsafe(board, child, true); //skip the root since it'll get logged when its parent is deallocated
 				board.unset(child->move);
 			}
-			nodes -= child->dealloc(ctmem);
+			if(cut){ //other threads may be in this subtree, so only take it out of the tree for now
+				Node * n = new Node();
+				if(child->children.detach(n->children))
+					cut->push_back(n);
+				else
+					delete n;
+			}else{
+				uword freed = child->dealloc(ctmem);
+				PLUS(nodes, -freed); //the reclaimer may be freeing at the same time
+				gcfreed += freed;
+			}
+		}
+	}
+}
+
+void Player::collect_concurrent(){
+	Time starttime;
+
+	gcretained += gckept;
+	vector<Node *> cut;
+	Board copy = rootboard;
+	garbage_collect(copy, & root, & cut);
+	for(unsigned int i = 0; i < roots.size(); i++){
+		copy = rootboard;
+		garbage_collect(copy, & roots[i], & cut);
+	}
+	flushlog();
+	ctmem.next_gen();
+	Time cuttime;
+
+	//the cut subtrees can't be reached from the roots anymore, but threads may still be in the middle of them
+	wait_epoch(INCR(gcepoch));
+	Time waittime;
+
+	uword freed = 0;
+	for(unsigned int i = 0; i < cut.size(); i++){
+		freed += cut[i]->dealloc(ctmem);
+		delete cut[i];
+	}
+	PLUS(nodes, -freed);
+	gcfreed += freed;
+	gckept = nodes;
+	Time freetime;
+	gcpasses.add(freetime - starttime);
+
+	logerr("Player GC while searching with limit " + to_str(gclimit) + " ... " + to_str(100.0*gckept/(gckept + freed), 1) + " % of tree remains - " +
+		to_str((cuttime - starttime)*1000, 0) + " msec cut, " + to_str((waittime - cuttime)*1000, 0) + " msec wait, " +
+		to_str((freetime - waittime)*1000, 0) + " msec free\n");
+
+	if(ctmem.meminuse() >= (maxmem - tt.memsize())*gcconcurrent/2)
+		gclimit = (int)(gclimit*1.3);
+	else if(gclimit > rollouts*5)
+		gclimit = (int)(gclimit*0.9); //slowly decay to a minimum of 5
+}
+
+void Player::wait_epoch(u64 e){
+	for(unsigned int i = 0; i < threads.size(); i++){
+		while(true){
+			u64 t = threads[i]->epoch;
+			if(t == 0 || t >= e)
+				break;
+			sched_yield();
 		}
 	}
 }
@@ -566,6 +920,37 @@ void Player::load_hgf(Board board, Node * node, FILE * fd){
 	return;
 }
 
+//count the nodes that break what the search threads must keep consistent: averages in range,
+//no more visits to the children than to their parent, and proofs that match their bestmove
+uword Player::check_tree(const Node * node) const {
+	uword errors = 0;
+
+	if(node->exp.sum() > node->exp.num() || node->rave.sum() > node->rave.num())
+		errors++;
+
+	uword childsims = 0;
+	for(Node * child = node->children.begin(), * end = node->children.end(); child != end; child++){
+		childsims += child->exp.num();
+		errors += check_tree(child);
+	}
+
+	//transpositions share their stats and proofs between subtrees, so the tree alone needn't add up
+	if(tt.size() == 0){
+		//a macro move starts with visitexpand wins of its own,
+		//and a node that was ever halved has more than maxnum/2 simulations and may have fewer than its children
+		if(node->exp.num() <= ExpPair::maxnum/2 && childsims > node->exp.num() + (node->children.num() == 1 ? visitexpand : 0))
+			errors++;
+
+		if(node->outcome >= 0){
+			Node * best = node->children.find(node->bestmove);
+			if(best && (best->outcome != node->outcome || best->proofdepth > node->proofdepth))
+				errors++;
+		}
+	}
+
+	return errors;
+}
+
 //does not handle draws...
 int Player::confirm_proof(const Board & board, Node * node, SolverAB & ab, SolverPNS & pns){
 	int toplay = board.toplay();
@@ -5,15 +5,17 @@
 
 #include <cmath>
 #include <cassert>
+#include <set>
 
 #include "time.h"
 #include "types.h"
 #include "move.h"
 #include "board.h"
 #include "depthstats.h"
+#include "pausestats.h"
 #include "thread.h"
 #include "xorshift.h"
-#include "weightedrandtree.h"
+#include "weightedrandbuckets.h"
 #include "lbdist.h"
 #include "compacttree.h"
 #include "log.h"
@@ -22,69 +24,284 @@
 
 class Player {
 public:
+#ifdef COMPACT
+	class RavePair;
+#endif
+
+	//halve a sum of outcomes and number of simulations until the number is at most maxnum, which keeps the average
+	static void halve(int64_t & s, int64_t & n, int64_t maxnum){
+		while(n > maxnum){
+			s = (s+1)/2;
+			n = (n+1)/2;
+		}
+	}
+
+	//the sum of outcomes (2 per win, 1 per tie) in the high 32 bits and the number of simulations in the low 32 bits,
+	//so both are updated with one atomic add and a copy is never torn between them.
+	//Both are halved once there are more than maxnum simulations, which keeps the average and leaves the sum, at most
+	//twice the number, below 2^31. A halved node can have fewer simulations than its children, or than a sibling it led.
 	class ExpPair {
-		uword s, n;
-		ExpPair(uword S, uword N) : s(S), n(N) { }
+		u64 v;
+		static u64 pack(int64_t s, int64_t n){ return ((u64)s << 32) + (u64)n; } //fields may go negative while they're being summed
+		static int64_t numof(u64 c){ return (int32_t)c; }
+		static int64_t sumof(u64 c){ return (int64_t)(c - (u64)numof(c)) >> 32; }
+		static u64 scale(int64_t s, int64_t n){
+			halve(s, n, maxnum);
+			return pack(s, n);
+		}
+		static bool full(u64 c){ return numof(c) > maxnum; }
+		void halvev(){
+			u64 c;
+			do{
+				c = v;
+				if(!full(c))
+					return;
+			}while(!CAS(v, c, scale(sumof(c), numof(c))));
+		}
+		void addpair(int64_t s, int64_t n){ v = scale(sumof(v) + s, numof(v) + n); }
+		ExpPair(uword S, uword N) : v(pack(S, N)) { }
+#ifdef COMPACT
+		friend class RavePair;
+#endif
 	public:
-		ExpPair() : s(0), n(0) { }
-		float avg() const { return 0.5f*s/n; }
-		uword num() const { return n; }
-		uword sum() const { return s/2; }
+		static const int64_t maxnum = 0x3FFF0000; //leaves room for the adds in flight before one of them halves
+
+		ExpPair() : v(0) { }
+		float avg() const { u64 c = v; return 0.5f*(c >> 32)/(uint32_t)c; }
+		uword num() const { return (uint32_t)v; }
+		uword sum() const { return (v >> 32)/2; }
 
-		void clear() { s = 0; n = 0; }
+		void clear() { v = 0; }
 
-		void addvloss(){ INCR(n); }
-		void addvtie() { INCR(s); }
-		void addvwin() { PLUS(s, 2); }
+		void addvloss(){ if(full(PLUS(v, pack(0, 1)))) halvev(); }
+		void addvtie() { PLUS(v, pack(1, 0)); }
+		void addvwin() { PLUS(v, pack(2, 0)); }
 		void addv(const ExpPair & a){
-			if(a.s) PLUS(s, a.s);
-			if(a.n) PLUS(n, a.n);
+			if(a.v && full(PLUS(v, a.v)))
+				halvev();
 		}
 
-		void addloss(){ n++; }
-		void addtie() { s++; }
-		void addwin() { s += 2; }
+		//single outcomes, for the counts of one rollout
+		void addloss(){ v += pack(0, 1); }
+		void addtie() { v += pack(1, 0); }
+		void addwin() { v += pack(2, 0); }
 		void add(const ExpPair & a){
-			s += a.s;
-			n += a.n;
+			addpair(sumof(a.v), numof(a.v));
 		}
 
-		void addwins(uword num)  { n += num; s += 2*num; }
-		void addlosses(uword num){ n += num; }
+		void addwins(iword num)  { addpair(2*num, num); }
+		void addlosses(iword num){ addpair(0, num); }
 		ExpPair & operator+=(const ExpPair & a){
-			s += a.s;
-			n += a.n;
+			add(a);
 			return *this;
 		}
 		ExpPair operator + (const ExpPair & a){
-			return ExpPair(s + a.s, n + a.n);
+			ExpPair r = *this;
+			r.add(a);
+			return r;
 		}
 		ExpPair & operator*=(uword m){
-			s *= m;
-			n *= m;
+			v = scale(sumof(v)*(int64_t)m, numof(v)*(int64_t)m);
 			return *this;
 		}
 		ExpPair invert(){
-			return ExpPair(n*2 - s, n);
+			u64 c = v;
+			return ExpPair((uint32_t)c*2 - (c >> 32), (uint32_t)c);
+		}
+		//take on the average of a pair with more experience, but keep this number of simulations
+		void setavg(const ExpPair & a){
+			u64 ac = a.v; //a copy, since other threads may be updating it
+			uword an = (uint32_t)ac;
+			u64 c, next;
+			do{
+				c = v;
+				uword n = (uint32_t)c;
+				if(an <= n)
+					return;
+				next = pack((uword)((double)(ac >> 32) * n / an), n);
+			}while(!CAS(v, c, next));
+		}
+	};
+
+#ifdef COMPACT
+	//rave experience in 32 bits: the sum of outcomes in the high 16 bits and the number of simulations in the low 16 bits
+	//both are halved once there are more than maxnum simulations, which keeps the average. Rave only blends in by the
+	//number of real simulations, so losing the old rave simulations doesn't change the value.
+	class RavePair {
+		uint32_t v;
+		static const uint32_t maxnum = 0x7FFF; //so the sum, up to twice the number, still fits in 16 bits
+
+		static uint32_t pack(int64_t s, int64_t n){
+			halve(s, n, maxnum);
+			return (uint32_t)((s << 16) | n);
+		}
+	public:
+		RavePair() : v(0) { }
+		RavePair & operator=(const ExpPair & a){
+			v = pack(a.v >> 32, (uint32_t)a.v);
+			return *this;
+		}
+		operator ExpPair() const { uint32_t c = v; return ExpPair(c >> 16, c & 0xFFFF); }
+
+		float avg() const { uint32_t c = v; return 0.5f*(c >> 16)/(c & 0xFFFF); }
+		uword num() const { return v & 0xFFFF; }
+		uword sum() const { return (v >> 16)/2; }
+
+		void clear() { v = 0; }
+
+		void addv(const ExpPair & a){
+			if(!a.v)
+				return;
+			uint32_t c, next;
+			do{
+				c = v;
+				next = pack((c >> 16) + (a.v >> 32), (c & 0xFFFF) + (uint32_t)a.v);
+			}while(!CAS(v, c, next));
+		}
+	};
+#else
+	typedef ExpPair RavePair;
+#endif
+
+	//outcome, proofdepth and bestmove sit together in one aligned 32 bit word in both Node and TransTable::Entry,
+	//so a proof is published with a single CAS and a thread that sees an outcome also sees how it was reached
+	typedef uint32_t __attribute__((__may_alias__)) proof_t;
+	union ProofWord {
+		proof_t word;
+		struct { int8_t outcome; uint8_t proofdepth; int8_t y, x; } p; //same layout as outcome, proofdepth, bestmove
+	};
+
+	//read the whole proof at once, so the proofdepth and bestmove match the outcome
+	template <class T> static ProofWord get_proof(const T * n){
+		ProofWord proof;
+		proof.word = *(const proof_t *) & n->outcome;
+		return proof;
+	}
+
+	//set the proof if the outcome is still oldoutcome, returns false if another thread changed it first
+	template <class T> static bool set_outcome(T * n, int oldoutcome, int outcome, int proofdepth, const Move & bestmove){
+		proof_t & word = *(proof_t *) & n->outcome;
+		assert(((uintptr_t) & word & 3) == 0);
+
+		ProofWord next;
+		next.p.outcome = outcome;
+		next.p.proofdepth = proofdepth;
+		next.p.y = bestmove.y;
+		next.p.x = bestmove.x;
+
+		ProofWord cur;
+		do{
+			cur.word = word;
+			if(cur.p.outcome != oldoutcome)
+				return false;
+		}while(!CAS(word, cur.word, next.word));
+		return true;
+	}
+
+	//stats of positions, shared by every path and thread that reaches them, for searching with transpositions
+	//the tree keeps its nodes as edges with their own experience, and takes on the average of the position
+	//entries are claimed with a CAS on the hash and never replaced while searching, so a full bucket just isn't shared
+	class TransTable {
+	public:
+		struct Entry {
+			hash_t   hash;  //0 for an empty slot
+			ExpPair  exp;
+			int8_t   outcome;  //a ProofWord, like in Node
+			uint8_t  proofdepth;
+			Move     bestmove; //only for positions past unique_depth, where the hash isn't shared with symmetric positions
+			uint16_t moves; //stones on the board, so positions behind the root can be collected
+
+			Entry() : hash(0), outcome(-3), proofdepth(0), moves(0) { }
+		};
+
+		static const unsigned int bucketsize = 4;
+
+	private:
+		Entry * table;
+		u64   numbuckets;
+		uword used;
+
+	public:
+		TransTable() : table(NULL), numbuckets(0), used(0) { }
+		~TransTable(){ alloc(0); }
+
+		void alloc(u64 bytes){
+			if(table)
+				delete[] table;
+			table = NULL;
+			used = 0;
+			numbuckets = bytes/(sizeof(Entry)*bucketsize);
+			if(numbuckets)
+				table = new Entry[numbuckets*bucketsize];
+		}
+		void clear(){
+			for(u64 i = 0; i < size(); i++)
+				table[i] = Entry();
+			used = 0;
+		}
+
+		u64   size()    const { return numbuckets*bucketsize; }
+		u64   memsize() const { return size()*sizeof(Entry); }
+		uword num()     const { return used; }
+		bool  full()    const { return (size() && used >= size()*3/4); }
+
+		//find the entry for this position, claiming an empty slot if it isn't there yet, NULL if its bucket is full
+		Entry * find(hash_t hash, int moves){
+			if(hash == 0) //0 marks an empty slot
+				hash = 1;
+
+			Entry * e = table + (hash % numbuckets)*bucketsize;
+			for(unsigned int i = 0; i < bucketsize; i++, e++){
+				if(e->hash == 0 && CAS(e->hash, (hash_t)0, hash)){
+					e->moves = moves;
+					INCR(used);
+					return e;
+				}
+				if(e->hash == hash) //already there, or another thread just claimed it
+					return e;
+			}
+			return NULL;
+		}
+
+		//drop positions with less experience than limit, or no more stones than the root so they can't be reached again
+		//only while the threads are stopped
+		uword gc(uword limit, int rootmoves){
+			uword dropped = 0;
+			for(u64 i = 0; i < size(); i++){
+				Entry & e = table[i];
+				if(e.hash && (e.exp.num() < limit || e.moves <= rootmoves)){
+					e = Entry();
+					dropped++;
+				}
+			}
+			used -= dropped;
+			return dropped;
 		}
 	};
 
+	//32 bytes, or 24 with COMPACT, which shrinks rave and children to 32 bits
+	//exp keeps its 32 bit counters either way, halved past ExpPair::maxnum so long searches don't overflow them
 	struct Node {
 	public:
+#ifdef COMPACT
+		ExpPair  exp;
+		RavePair rave;
+#else
 		ExpPair rave;
 		ExpPair exp;
+#endif
 		int16_t know;
-		int8_t  outcome;
-		uint8_t proofdepth;
 		Move    move;
+		int8_t  outcome;  //outcome, proofdepth and bestmove form one ProofWord, set them together with set_outcome
+		uint8_t proofdepth;
 		Move    bestmove; //if outcome is set, then bestmove is the way to get there
 		CompactTree<Node>::Children children;
 //		int padding;
 		//seems to need padding to multiples of 8 bytes or it segfaults?
 		//don't forget to update the copy constructor/operator
 
-		Node()                            : know(0), outcome(-3), proofdepth(0)          { }
-		Node(const Move & m, char o = -3) : know(0), outcome( o), proofdepth(0), move(m) { }
+		Node()                            : know(0),          outcome(-3), proofdepth(0) { }
+		Node(const Move & m, char o = -3) : know(0), move(m), outcome( o), proofdepth(0) { }
 		Node(const Node & n) { *this = n; }
 		Node & operator = (const Node & n){
 			if(this != & n){ //don't copy to self
@@ -151,20 +368,21 @@ public:
 		//new way, more standard way of changing over from rave scores to real scores
 		float value(float ravefactor, bool knowledge, float fpurgency){
 			float val = fpurgency;
-			float expnum = exp.num();
-			float ravenum = rave.num();
+			ExpPair e = exp, r = rave; //copies, so the nums and avgs match while other threads update them
+			float expnum = e.num();
+			float ravenum = r.num();
 
 			if(ravefactor <= min_rave){
 				if(expnum > 0)
-					val = exp.avg();
+					val = e.avg();
 			}else if(ravenum > 0 || expnum > 0){
 				float alpha = ravefactor/(ravefactor + expnum);
 //				float alpha = sqrt(ravefactor/(ravefactor + 3.0f*expnum));
 //				float alpha = ravenum/(expnum + ravenum + expnum*ravenum*ravefactor);
 
 				val = 0;
-				if(ravenum > 0) val += alpha*rave.avg();
-				if(expnum  > 0) val += (1.0f-alpha)*exp.avg();
+				if(ravenum > 0) val += alpha*r.avg();
+				if(expnum  > 0) val += (1.0f-alpha)*e.avg();
 			}
 
 			if(knowledge && know > 0){
@@ -188,6 +406,7 @@ public:
 
 		ExpPair  exp[2];       //aggregated outcomes overall
 		ExpPair  rave[2][361]; //aggregated outcomes per move
+		BitBoard played[2];    //cells with rave outcomes per player, so reset only clears those and update_rave skips the rest
 		RaveMove moves[361];   //moves made in order
 		int      tree;         //number of moves in the tree
 		int      rollout;      //number of moves in the rollout
@@ -199,7 +418,7 @@ public:
 			moves[tree++] = RaveMove(move, player);
 		}
 		void addrollout(const Move & move, char player){
-			moves[rollout++] = RaveMove(move, player);
+			moves[tree + rollout++] = RaveMove(move, player);
 		}
 		void reset(Board * b){
 			tree = 0;
@@ -207,9 +426,27 @@ public:
 			board = b;
 			exp[0].clear();
 			exp[1].clear();
-			for(int i = 0; i < b->vecsize(); i++){
-				rave[0][i].clear();
-				rave[1][i].clear();
+			for(int p = 0; p < 2; p++){
+				for(int i = played[p].first(); i >= 0; i = played[p].next(i))
+					rave[p][i].clear();
+				played[p].clear();
+			}
+		}
+		//start from the same tree moves as another list, for rollouts from its leaf
+		void copytree(const MoveList & o){
+			reset(o.board);
+			tree = o.tree;
+			for(int i = 0; i < tree; i++)
+				moves[i] = o.moves[i];
+		}
+		//add the outcomes of rollouts from the same leaf
+		void add(const MoveList & o){
+			exp[0] += o.exp[0];
+			exp[1] += o.exp[1];
+			for(int p = 0; p < 2; p++){
+				for(int i = o.played[p].first(); i >= 0; i = o.played[p].next(i))
+					rave[p][i] += o.rave[p][i];
+				played[p] |= o.played[p];
 			}
 		}
 		void finishrollout(int won){
@@ -222,7 +459,9 @@ public:
 				exp[won-1].addwin();
 
 				for(RaveMove * i = begin(), * e = end(); i != e; i++){
-					ExpPair & r = rave[i->player-1][board->xy(*i)];
+					int xy = board->xy(*i);
+					played[i->player-1].set(xy);
+					ExpPair & r = rave[i->player-1][xy];
 					r.addloss();
 					if(i->player == won)
 						r.addwin();
@@ -243,6 +482,9 @@ public:
 		const ExpPair & getrave(int player, const Move & move) const {
 			return rave[player-1][board->xy(move)];
 		}
+		const BitBoard & getplayed(int player) const {
+			return played[player-1];
+		}
 		const ExpPair & getexp(int player) const {
 			return exp[player-1];
 		}
@@ -259,13 +501,22 @@ public:
 		DepthStats treelen, gamelen;
 		DepthStats wintypes[2][4]; //player,wintype
 		double times[4]; //time spent in each of the stages
+		volatile u64 epoch; //the gc epoch when the current iteration started, 0 between iterations
 
-		PlayerThread() : rand32(std::rand()), unitrand(std::rand()) {}
+		PlayerThread() : rand32(std::rand()), unitrand(std::rand()), epoch(0) {}
 		virtual ~PlayerThread() { }
+		//restart the random numbers from a fixed seed, to reproduce a run, 0 keeps the ones from std::rand
+		void seed(uint32_t s) {
+			if(s){
+				rand32.seed(s);
+				unitrand = XORShift_float(s ^ 0x9E3779B9);
+			}
+		}
 		virtual void reset() { }
 		int join(){ return thread.join(); }
 		void run(); //thread runner, calls iterate on each iteration
 		virtual void iterate() { } //handles each iteration
+		virtual void stop() { } //cut a long iteration short, the threads are stopping, may be called from the alarm
 	};
 
 	class PlayerUCT : public PlayerThread {
@@ -273,21 +524,72 @@ public:
 		bool use_rave;    //whether to use rave for this simulation
 		bool use_explore; //whether to use exploration for this simulation
 		int  rollout_pattern_offset; //where to start the rollout pattern
-		Move moves[361]; //moves in the rollout
-		WeightedRandTree wtree[2]; //hold the weights for weighted random values, one per player
+		WeightedRandBuckets wtree[2]; //hold the weights for weighted random values, one per player
+		WeightedRandBuckets wroot[2]; //the weights for the root board, each rollout starts from them and updates the tree moves
+		hash_t wroothash; //which root board wroot holds
+		int    wrootmoves; //and how many moves it had, -1 for none
 		LBDists dists;    //holds the distances to the various non-ring wins as a heuristic for the minimum moves needed to win
 		MoveList movelist;
 		int stage; //which of the four MCTS stages is it on
 		Time timestamps[4]; //timestamps for the beginning, before child creation, before rollout, after rollout
+		int id; //which of the separate trees to search with root parallelization
+
+		//leaf parallelization, helpers run a share of the rollouts from each of the leader's leaves
+		PlayerUCT * leader;          //the search thread this one runs rollouts for, NULL for a search thread
+		vector<PlayerUCT *> helpers;
+		Barrier leafstart, leafend;  //around each batch of rollouts, for the leader and its helpers
+		const Board * leafboard;     //the leaf to run rollouts from, set by the leader
+		Move leafmove;
+		int  leafdepth;
+		int  leafruns;               //this helper's share of the rollouts
+		bool leafexit;               //set by the leader to stop its helpers
 
 	public:
-		PlayerUCT(Player * p) {
+		PlayerUCT(Player * p, int i) {
 			PlayerThread();
 			player = p;
+			id = i;
+			leader = NULL;
+			leafexit = false;
 			reset();
+			seed(player->next_seed());
+
+			if(player->leafpar > 0){
+				leafstart.reset(player->leafpar + 1);
+				leafend.reset(player->leafpar + 1);
+				for(int h = 0; h < player->leafpar; h++)
+					helpers.push_back(new PlayerUCT(p, this));
+			}
+
 			thread(bind(&PlayerUCT::run, this));
 		}
+		PlayerUCT(Player * p, PlayerUCT * l) {
+			PlayerThread();
+			player = p;
+			id = l->id;
+			leader = l;
+			leafexit = false;
+			reset();
+			seed(player->next_seed());
+			thread(bind(&PlayerUCT::helper_run, this));
+		}
+		~PlayerUCT(){
+			if(helpers.size()){
+				leafexit = true;
+				leafstart.wait();
+				for(unsigned int h = 0; h < helpers.size(); h++){
+					helpers[h]->join();
+					delete helpers[h];
+				}
+			}
+		}
 
+		//the thread's own random numbers, and the weighted random choices from them
+		void seed(uint32_t s){
+			PlayerThread::seed(s);
+			wtree[0].seed(rand32());
+			wtree[1].seed(rand32());
+		}
 		void reset(){
 			treelen.reset();
 			gamelen.reset();
@@ -299,6 +601,7 @@ public:
 			use_rave = false;
 			use_explore = false;
 			rollout_pattern_offset = 0;
+			wrootmoves = -1; //rebuilt in case the gammas changed
 
 			for(int a = 0; a < 2; a++)
 				for(int b = 0; b < 4; b++)
@@ -313,13 +616,56 @@ public:
 		void walk_tree(Board & board, Node * node, int depth);
 		bool create_children(Board & board, Node * node, int toplay);
 		void add_knowledge(Board & board, Node * node, Node * child);
-		Node * choose_move(const Node * node, int toplay, int remain) const;
 		void update_rave(const Node * node, int toplay);
 		bool test_bridge_probe(const Board & board, const Move & move, const Move & test) const;
+		bool test_bridge_probe_scan(const Board & board, const Move & move, const Move & test) const;
 
 		int rollout(Board & board, Move move, int depth);
+		void set_weights(const Board & board, WeightedRandBuckets * w);
+		void update_weights(const Board & board, int xy);
+		void leaf_rollouts(const Board & board, const Move & move, int depth);
+		void helper_run(); //thread runner for a helper, runs its share of rollouts from each leaf
+
+	public:
+		Node * choose_move(const Node * node, int toplay, int remain, bool simd = true) const;
+		//calls of choose_move per second over the children of node, for bench_choose
+		double time_choose(const Node * node, int toplay, bool simd, double len, Node * & best);
+		//differences between the bridge tables and the scans they replace around move, for check_bridge
+		int check_bridge(const Board & board, const Move & move);
+
+	private:
+#ifdef __AVX2__
+		//score children 8 at a time from begin, stopping before the last partial block, see choose_move
+		Node * choose_move_avx2(Node * child, Node * end, int toplay, float logvisits, float raveval, float explore, Node * & ret, float & maxval) const;
+#endif
 		PairMove rollout_choose_move(Board & board, const Move & prev, int & doinstwin, bool checkrings);
 		Move rollout_pattern(const Board & board, const Move & move);
+		Move rollout_pattern_scan(const Board & board, const Move & move, int a) const;
+	};
+
+	//proves heavy unsolved nodes with proof number search alongside the search threads, backing the proofs up the tree
+	//the way the search threads do, so forced lines are proven without the rollouts to confirm them
+	class PlayerProver : public PlayerThread {
+		SolverPNS pns;
+		set<hash_t> failed; //positions that couldn't be proven within provemem, they're skipped to look deeper
+		int id; //which of the separate trees to prove in with root parallelization
+
+	public:
+		PlayerProver(Player * p, int i) {
+			player = p;
+			id = i;
+			seed(player->next_seed());
+			pns.set_memlimit((u64)player->provemem*1024*1024);
+			thread(bind(&PlayerProver::run, this));
+		}
+
+		void stop(){
+			pns.stop();
+		}
+
+	private:
+		void iterate();
+		Node * choose_node(Node * top, Board & board, vector<Move> & path);
 	};
 
 
@@ -329,8 +675,13 @@ public:
 
 	bool  ponder;     //think during opponents time?
 	int   numthreads; //number of player threads to run
+	int   leafpar;    //number of helper threads per player thread that run rollouts from its leaves
+	int   rootpar;    //number of separate trees for root parallelization, shared round robin by the threads, 0 for one shared tree
+	uint  rootsync;   //msec between merging the separate trees into the root while searching, 0 to only merge at the end
 	u64   maxmem;     //maximum memory for the tree in bytes
 	bool  profile;    //count how long is spent in each stage of MCTS
+	uint32_t seed;    //seed for the random numbers of each thread, so single threaded runs can be reproduced, 0 to seed from the clock
+	uint32_t seeds;   //threads seeded since they were last reset
 //final move selection
 	float msrave;     //rave factor in final move selection, -1 means use number instead of value
 	float msexplore;  //the UCT constant in final move selection
@@ -354,6 +705,12 @@ public:
 	uint  visitexpand;//number of visits before expanding a node
 	bool  prunesymmetry; //prune symmetric children from the move list, useful for proving but likely not for playing
 	uint  gcsolved;   //garbage collect solved nodes or keep them in the tree, assuming they meet the required amount of work
+	float gcconcurrent; //collect while searching once the tree uses this fraction of maxmem, 0 to only collect with all threads stopped
+	float gcdecay;    //weight on the experience of a subtree for each collection it went unvisited, 1 to collect by experience alone
+	int   provers;    //number of threads proving heavy nodes with proof number search, only with minimax
+	uint  provemin;   //experience a node needs before the provers try it
+	uint  provemem;   //memory for each prover's proof number search in Mb, which bounds how long each attempt takes
+	float transpose;  //fraction of maxmem for a table of position stats shared between transpositions, 0 to disable
 //knowledge
 	int   localreply; //boost for a local reply, ie a move near the previous move
 	int   locality;   //boost for playing near previous stones
@@ -374,15 +731,52 @@ public:
 	int   instwindepth;   //how deep to look for instant wins
 
 	float gammas[4096]; //pattern weights for weighted random
+	int8_t  bridgereply[6][4096]; //the direction of the reply that saves a bridge after a probe, by the direction the rollouts
+	                              //start looking from and the pattern around the probe with the replying player as 1, -1 for none
+	uint8_t bridgeprobe[4096];    //a bit per direction of all the replies that save a bridge, by the same pattern
 
 	Board rootboard;
 	Node  root;
+	vector<Node> roots; //the separate trees for root parallelization, their root children are merged into root
 	uword nodes;
 	int   gclimit; //the minimum experience needed to not be garbage collected
 
 	uint64_t runs, maxruns;
+	uword proofs, proofattempts; //by the provers
 
 	CompactTree<Node> ctmem;
+	TransTable tt;
+
+	Time lastsync; //last time the separate trees were merged
+	int  syncing;  //claimed by the thread merging the separate trees
+
+	volatile u64 gcepoch; //advanced after cutting subtrees out of the tree, they're freed once no thread is in an older epoch
+	int  gcing;    //claimed by the thread collecting while the others search
+	PauseStats gcpauses;  //collections with all threads stopped
+	PauseStats gcpasses;  //collections while the other threads search, how long the collecting thread was busy
+	u64   gcfreed;     //nodes freed by collections, so the nodes created are these plus the nodes in the tree
+	uword gckept;      //nodes left by the last collection
+	u64   gcretained;  //nodes left by each collection, summed
+	u64   gcrevisited; //how many of those were walked through again before the next collection
+
+	//subtrees discarded by move and set_board, freed in the background while the next search runs
+	struct Retired {
+		Node * node;  //holds the detached subtree
+		Board  board; //the position at node, to log its solved nodes
+		bool   log;
+		uword  report;    //the nodes before the move, to log what was kept once this and everything before it is freed
+		uword  reclaimed; //the nodes reclaimed before the move
+		double ready;     //how long the move took until the threads could search again
+		Time   queued;    //when it was handed to the reclaimer
+	};
+	vector<Retired> retired;  //detached but not handed to the reclaimer yet, only while the threads are stopped
+	vector<Retired> reclaimq; //guarded by reclaimcond
+	CondVar reclaimcond;  //signalled when there's something to reclaim
+	Mutex   reclaimlock;  //held while freeing a subtree, so compaction doesn't move it
+	volatile int reclaiming; //subtrees retired but not freed yet
+	uword   reclaimed;    //nodes freed by the reclaimer, only written by it
+	bool    reclaimexit;
+	Thread  reclaimer;
 
 	string solved_logname;
 	FILE * solved_logfile;
@@ -406,17 +800,28 @@ public:
 	~Player();
 
 	void timedout();
+	void interrupt(); //cut the long iterations of the provers short
 
 	string statestring();
 
 	void stop_threads();
 	void start_threads();
 	void reset_threads();
+	void set_bridge_tables();
+	uint32_t next_seed(){ return (seed ? seed + 0x9E3779B9*(seeds++) : 0); } //the threads are created in the same order each time
 
 	void set_ponder(bool p);
 	void set_board(const Board & board);
+	void set_transpose(float t);
+	void set_rootpar(int r);
 
 	void move(const Move & m);
+	void move_root(Node & node, const Move & m, bool log); //follow the move in this tree, keeping the subtree if keeptree
+	void retire(Node & node, bool log); //detach the subtree to be reclaimed, only while the threads are stopped
+	void reclaim(uword nodesbefore = 0, uword reclaimedbefore = 0, double ready = 0); //hand the retired subtrees to the reclaimer
+	void reclaim_run(); //the reclaimer thread
+	uword reclaim_free(Node * node); //free a subtree, taking each block off nodes as it goes
+	void reclaim_wait(); //wait for everything retired so far to be freed
 
 	double gamelen();
 
@@ -426,8 +831,12 @@ public:
 	void logsolved_unsafe(Board & board, const Node * node, bool skiproot); //modifies the board
 
 	Node * genmove(double time, int max_runs, bool flexible);
+	void reset_roots(); //only while the threads are stopped
+	void merge_roots();
 	vector<Move> get_pv();
-	void garbage_collect(Board & board, Node * node); //destroys the board, so pass in a copy
+	void garbage_collect(Board & board, Node * node, vector<Node *> * cut = NULL); //destroys the board, so pass in a copy
+	void collect_concurrent(); //garbage collect while the other threads keep searching
+	void wait_epoch(u64 e); //wait for all threads to finish iterations started before epoch e
 
 	bool do_backup(Node * node, Node * backup, int toplay);
 
@@ -438,6 +847,7 @@ public:
 	Node * find_child(Node * node, const Move & move);
 
 	int confirm_proof(const Board & board, Node * node, SolverAB & ab, SolverPNS & pns);
+	uword check_tree(const Node * node) const; //only while the threads are stopped
 
 protected:
 	Node * return_move(Node * node, int toplay) const;
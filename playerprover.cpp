@@ -0,0 +1,115 @@
+
+#include "player.h"
+#include <unistd.h>
+
+void Player::PlayerProver::iterate(){
+	if(player->minimax == 0){ //proofs are only used by the minimax search
+		usleep(1000);
+		return;
+	}
+
+	//with root parallelization the provers take turns with the separate trees, a proof in one is shared with the others
+	Node * top = (player->roots.empty() ? & player->root : & player->roots[id % player->roots.size()]);
+
+	Board board = player->rootboard;
+	vector<Move> path;
+	Node * node = choose_node(top, board, path);
+	if(node == NULL){ //nothing heavy enough yet
+		usleep(1000);
+		return;
+	}
+	hash_t hash = board.gethash();
+
+	//this can take a while, and the nodes may be collected meanwhile, so let the collector go ahead and find the node again after
+	__sync_lock_release(&epoch);
+
+	INCR(player->proofattempts);
+	pns.set_board(board);
+	if(player->threadstate != Thread_Running) //stopped before set_board reset the timeout
+		return;
+	pns.solve_mem();
+
+	if(pns.outcome < 0){
+		if(player->threadstate == Thread_Running){ //ran out of memory, so look deeper next time
+			if(failed.size() >= 100000) //mostly positions from earlier in the game by now
+				failed.clear();
+			failed.insert(hash);
+		}
+		return;
+	}
+
+	epoch = player->gcepoch;
+	__sync_synchronize();
+
+	vector<Node *> nodes;
+	nodes.push_back(top);
+	for(unsigned int i = 0; i < path.size(); i++){
+		Node * child = nodes.back()->children.find(path[i]);
+		if(child == NULL) //collected while proving
+			return;
+		nodes.push_back(child);
+	}
+	node = nodes.back();
+
+	//the child that wins or draws gets the proof too, so the node's bestmove matches the child
+	int proofdepth = min(max(pns.maxdepth, 1), 255);
+	Node * best = node->children.find(pns.bestmove);
+	if(best){
+		int bestoutcome = best->outcome;
+		if(bestoutcome < 0)
+			set_outcome(best, bestoutcome, pns.outcome, proofdepth-1, Move(M_NONE));
+	}
+	int nodeoutcome = node->outcome;
+	if(nodeoutcome >= 0 || !set_outcome(node, nodeoutcome, pns.outcome, proofdepth, pns.bestmove))
+		return; //proven by the search meanwhile
+
+	INCR(player->proofs);
+
+	int toplay = player->rootboard.toplay(); //at the top
+	for(int i = nodes.size() - 2; i >= 0; i--)
+		if(!player->do_backup(nodes[i], nodes[i+1], (i % 2 ? 3 - toplay : toplay)))
+			break;
+
+	if(top != & player->root){
+		ProofWord proof = get_proof(top);
+		int rootoutcome = player->root.outcome;
+		if(proof.p.outcome >= 0 && rootoutcome < 0) //merged once the threads stop
+			set_outcome(& player->root, rootoutcome, proof.p.outcome, proof.p.proofdepth, Move(proof.p.x, proof.p.y));
+	}
+}
+
+//follow the children with at least provemin experience, picked at random by experience so the provers spread out over
+//the heavy lines, down to the first unsolved position this prover hasn't failed on. The root is left to the search.
+Player::Node * Player::PlayerProver::choose_node(Node * top, Board & board, vector<Move> & path){
+	Node * node = top;
+	while(true){
+		if(node->outcome >= 0)
+			return NULL;
+		if(node != top && failed.find(board.gethash()) == failed.end())
+			return node;
+
+		u64 total = 0;
+		Node * end, * child = node->children.range(end);
+		for(Node * c = child; c != end; c++)
+			if(c->outcome < 0 && c->exp.num() >= player->provemin)
+				total += c->exp.num();
+		if(total == 0)
+			return NULL;
+
+		u64 r = (total * rand32()) >> 32;
+		Node * pick = NULL;
+		for(Node * c = child; c != end; c++){
+			uword num = c->exp.num(); //others may be adding to it, so the last one is the fallback
+			if(c->outcome < 0 && num >= player->provemin){
+				pick = c;
+				if(r < num)
+					break;
+				r -= num;
+			}
+		}
+
+		board.move(pick->move);
+		path.push_back(pick->move);
+		node = pick;
+	}
+}
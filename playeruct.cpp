@@ -3,20 +3,42 @@
 #include <cmath>
 #include <string>
 #include "string.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 void Player::PlayerUCT::iterate(){
+	INCR(player->runs);
+
 	if(player->profile){
 		timestamps[0] = Time();
 		stage = 0;
 	}
 
+	//with root parallelization each group of threads searches its own tree
+	Node * root = (player->roots.empty() ? & player->root : & player->roots[id % player->roots.size()]);
+
 	movelist.reset(&(player->rootboard));
-	player->root.exp.addvloss();
+	root->exp.addvloss();
 	Board copy = player->rootboard;
 	use_rave    = (unitrand() < player->userave);
 	use_explore = (unitrand() < player->useexplore);
-	walk_tree(copy, & player->root, 0);
-	player->root.exp.addv(movelist.getexp(3-player->rootboard.toplay()));
+	walk_tree(copy, root, 0);
+	root->exp.addv(movelist.getexp(3-player->rootboard.toplay()));
+
+	if(root != & player->root){
+		//a proof in any tree is a proof for all of them, publishing it stops every thread
+		ProofWord proof = get_proof(root);
+		int rootoutcome = player->root.outcome;
+		if(proof.p.outcome >= 0 && rootoutcome < 0) //merged once the threads stop
+			set_outcome(& player->root, rootoutcome, proof.p.outcome, proof.p.proofdepth, Move(proof.p.x, proof.p.y));
+
+		if(player->rootsync && Time() - player->lastsync >= player->rootsync/1000.0 && CAS(player->syncing, 0, 1)){
+			player->merge_roots();
+			player->lastsync = Time();
+			player->syncing = 0;
+		}
+	}
 
 	if(player->profile){
 		times[0] += timestamps[1] - timestamps[0];
@@ -30,11 +52,15 @@ void Player::PlayerUCT::walk_tree(Board & board, Node * node, int depth){
 	int toplay = board.toplay();
 
 	if(!node->children.empty() && node->outcome < 0){
+		node->children.stamp(player->ctmem.gen()); //recently walked subtrees survive garbage collection
+
 	//choose a child and recurse
 		Node * child;
 		do{
 			int remain = board.movesremain();
 			child = choose_move(node, toplay, remain);
+			if(child == NULL) //the children were just collected, so this is a leaf again
+				break;
 
 			if(child->outcome < 0){
 				movelist.addtree(child->move, toplay);
@@ -46,10 +72,34 @@ void Player::PlayerUCT::walk_tree(Board & board, Node * node, int depth){
 
 				child->exp.addvloss(); //balanced out after rollouts
 
+				//the shared stats of this position, however it was reached
+				TransTable::Entry * entry = NULL;
+				int entrymoves = board.num_moves(); //walk_tree keeps playing on this board
+				if(player->tt.size()){
+					entry = player->tt.find(board.gethash(), entrymoves);
+					if(entry){
+						entry->exp.addvloss();
+						ProofWord proof = get_proof(entry);
+						int childoutcome = child->outcome;
+						if(player->minimax && proof.p.outcome >= 0 && childoutcome < 0) //solved through a transposition
+							set_outcome(child, childoutcome, proof.p.outcome, proof.p.proofdepth, Move(proof.p.x, proof.p.y));
+					}
+				}
+
 				walk_tree(board, child, depth+1);
 
 				child->exp.addv(movelist.getexp(toplay));
 
+				if(entry){
+					entry->exp.addv(movelist.getexp(toplay));
+					child->exp.setavg(entry->exp);
+
+					ProofWord proof = get_proof(child);
+					if(player->minimax && proof.p.outcome >= 0 && entry->outcome < 0)
+						set_outcome(entry, -3, proof.p.outcome, proof.p.proofdepth,
+							(entrymoves > board.get_unique_depth() ? Move(proof.p.x, proof.p.y) : Move(M_UNKNOWN)));
+				}
+
 				if(!player->do_backup(node, child, toplay) && //not solved
 					player->ravefactor > min_rave &&  //using rave
 					node->children.num() > 1 &&       //not a macro move
@@ -60,7 +110,8 @@ void Player::PlayerUCT::walk_tree(Board & board, Node * node, int depth){
 			}
 		}while(!player->do_backup(node, child, toplay));
 
-		return;
+		if(child)
+			return;
 	}
 
 	if(player->profile && stage == 0){
@@ -84,9 +135,13 @@ void Player::PlayerUCT::walk_tree(Board & board, Node * node, int depth){
 		}
 
 		//do random game on this node
-		for(int i = 0; i < player->rollouts; i++){
-			Board copy = board;
-			rollout(copy, node->move, depth);
+		if(helpers.size()){
+			leaf_rollouts(board, node->move, depth);
+		}else{
+			for(int i = 0; i < player->rollouts; i++){
+				Board copy = board;
+				rollout(copy, node->move, depth);
+			}
 		}
 	}else{
 		movelist.finishrollout(won); //got to a terminal state, it's worth recording
@@ -119,10 +174,11 @@ bool Player::PlayerUCT::create_children(Board & board, Node * node, int toplay){
 
 		if(player->detectdraw){
 //			assert(node->outcome == -3);
-			node->outcome = dists.isdraw(); //could be winnable by only one side
+			int draw = dists.isdraw(); //could be winnable by only one side
+			//a proven draw means neither side can influence the outcome, so just choose the first move since all are equal at this point
+			set_outcome(node, node->outcome, draw, node->proofdepth, (draw == 0 ? Move(*(board.moveit())) : node->bestmove));
 
-			if(node->outcome == 0){ //proven draw, neither side can influence the outcome
-				node->bestmove = *(board.moveit()); //just choose the first move since all are equal at this point
+			if(draw == 0){
 				node->children.unlock();
 				return true;
 			}
@@ -137,23 +193,31 @@ bool Player::PlayerUCT::create_children(Board & board, Node * node, int toplay){
 	Node * child = temp.begin(),
 	     * end   = temp.end(),
 	     * loss  = NULL;
+
+	//the immediate wins for both sides, found for all moves at once
+	BitBoard wins, threats;
+	if(player->minimax){
+		wins = board.winmask(board.toplay());
+		if(player->minimax >= 2)
+			threats = board.winmask(3 - board.toplay());
+	}
+	int tie = (board.num_moves() + 1 == board.numcells() ? 0 : -3);
+
 	Board::MoveIterator move = board.moveit(player->prunesymmetry);
 	int nummoves = 0;
 	for(; !move.done() && child != end; ++move, ++child){
 		*child = Node(*move);
 
-		if(player->minimax){
-			child->outcome = board.test_win(*move);
+		if(player->minimax && *move != M_SWAP){
+			child->outcome = (wins.test(board.xy(*move)) ? board.toplay() : tie);
 
-			if(player->minimax >= 2 && board.test_win(*move, 3 - board.toplay()) > 0){
+			if(threats.test(board.xy(*move))){
 				losses++;
 				loss = child;
 			}
 
 			if(child->outcome == toplay){ //proven win from here, don't need children
-				node->outcome = child->outcome;
-				node->proofdepth = 1;
-				node->bestmove = *move;
+				set_outcome(node, node->outcome, child->outcome, 1, *move);
 				node->children.unlock();
 				temp.dealloc(player->ctmem);
 				return true;
@@ -178,9 +242,7 @@ bool Player::PlayerUCT::create_children(Board & board, Node * node, int toplay){
 		macro.exp.addwins(player->visitexpand);
 		*(temp.begin()) = macro;
 	}else if(losses >= 2){ //proven loss, but at least try to block one of them
-		node->outcome = 3 - toplay;
-		node->proofdepth = 2;
-		node->bestmove = loss->move;
+		set_outcome(node, node->outcome, 3 - toplay, 2, loss->move);
 		node->children.unlock();
 		temp.dealloc(player->ctmem);
 		return true;
@@ -196,7 +258,7 @@ bool Player::PlayerUCT::create_children(Board & board, Node * node, int toplay){
 	return true;
 }
 
-Player::Node * Player::PlayerUCT::choose_move(const Node * node, int toplay, int remain) const {
+Player::Node * Player::PlayerUCT::choose_move(const Node * node, int toplay, int remain, bool simd) const {
 	float val, maxval = -1000000000;
 	float logvisits = log(node->exp.num());
 	unsigned int dynwidenlim = (player->dynwiden > 0 ? (unsigned int)(logvisits/player->logdynwiden) : 361);
@@ -206,9 +268,17 @@ Player::Node * Player::PlayerUCT::choose_move(const Node * node, int toplay, int
 	if(player->parentexplore)
 		explore *= node->exp.avg();
 
-	Node * ret = NULL,
-		 * child = node->children.begin(),
-		 * end   = node->children.end();
+	Node * ret = NULL, * end,
+		 * child = node->children.range(end);
+
+#ifdef __AVX2__
+	//the full blocks of 8 first, the same choice as the loop below, then it finishes the rest
+	if(simd){
+		child = choose_move_avx2(child, end, toplay, logvisits, raveval, explore, ret, maxval);
+		if(ret && ret->outcome == toplay)
+			return ret;
+	}
+#endif
 
 	for(; child != end && dynwidenlim >= 0; child++, dynwidenlim--){
 		if(child->outcome >= 0){
@@ -231,6 +301,140 @@ Player::Node * Player::PlayerUCT::choose_move(const Node * node, int toplay, int
 	return ret;
 }
 
+#ifdef __AVX2__
+//Node::value plus exploration for 8 children at once, gathered straight out of the Node array
+//Nodes are 32 bytes: rave num/sum, exp num/sum, know and move, then outcome, proofdepth and bestmove, as 32 bit words 0,1,2,3,4,5
+//With COMPACT they're 24 bytes: exp num/sum, rave num and sum packed in one word, know and move, then the outcome, as words 0,1,2,3,4
+#ifdef COMPACT
+static const int NODE_WORDS = 6, EXP_WORD = 0, RAVE_WORD = 2, KNOW_WORD = 3, OUTCOME_WORD = 4;
+#else
+static const int NODE_WORDS = 8, EXP_WORD = 2, RAVE_WORD = 0, KNOW_WORD = 4, OUTCOME_WORD = 5;
+#endif
+
+//the ExpPairs of 8 nodes, each read as one 64 bit word so an update can't land between its num and sum,
+//split into num from the low and sum from the high halves. Both stay below 2^31, so they convert as signed.
+static inline void gather_pairs(const int * p, __m256i stride, __m256 & num, __m256 & sum){
+	__m256 lo = _mm256_castsi256_ps(_mm256_i32gather_epi64((const long long *) p, _mm256_castsi256_si128(stride), 4));
+	__m256 hi = _mm256_castsi256_ps(_mm256_i32gather_epi64((const long long *) p, _mm256_extracti128_si256(stride, 1), 4));
+	//n0 n1 n4 n5 n2 n3 n6 n7, then back in order
+	num = _mm256_cvtepi32_ps(_mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+	sum = _mm256_cvtepi32_ps(_mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+Player::Node * Player::PlayerUCT::choose_move_avx2(Node * child, Node * end, int toplay, float logvisits, float raveval, float explore, Node * & ret, float & maxval) const {
+	assert(sizeof(Node) == NODE_WORDS*4);
+
+	const __m256i lanes  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i stride = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(NODE_WORDS));
+	const __m256  zero   = _mm256_setzero_ps();
+	const __m256  one    = _mm256_set1_ps(1);
+	const __m256  half   = _mm256_set1_ps(0.5f);
+	const __m256  fpu    = _mm256_set1_ps(player->fpurgency);
+	const __m256  rf     = _mm256_set1_ps(raveval);
+	const __m256  logv   = _mm256_set1_ps(logvisits);
+	const __m256  expl   = _mm256_set1_ps(explore);
+	const __m256i play   = _mm256_set1_epi32(toplay);
+	const bool userave   = (raveval > min_rave);
+	const bool know      = player->knowledge;
+
+	__m256  bestval = _mm256_set1_ps(maxval);
+	__m256i bestidx = _mm256_set1_epi32(-1);
+
+	Node * begin = child;
+	for(; end - child >= 8; child += 8){
+		const int * base = (const int *) child;
+#ifdef COMPACT
+		__m256i rave    = _mm256_i32gather_epi32(base + RAVE_WORD, stride, 4);
+		__m256  ravenum = _mm256_cvtepi32_ps(_mm256_and_si256(rave, _mm256_set1_epi32(0xFFFF)));
+		__m256  ravesum = _mm256_cvtepi32_ps(_mm256_srli_epi32(rave, 16));
+#else
+		__m256  ravenum, ravesum;
+		gather_pairs(base + RAVE_WORD, stride, ravenum, ravesum);
+#endif
+		__m256  expnum, expsum;
+		gather_pairs(base + EXP_WORD, stride, expnum, expsum);
+		__m256i outcome = _mm256_i32gather_epi32(base + OUTCOME_WORD, stride, 4);
+		outcome = _mm256_srai_epi32(_mm256_slli_epi32(outcome, 24), 24); //the low byte, sign extended
+
+		__m256i win = _mm256_cmpeq_epi32(outcome, play);
+		if(!_mm256_testz_si256(win, win)){ //return the first win immediately
+			ret = child + __builtin_ctz(_mm256_movemask_ps(_mm256_castsi256_ps(win)));
+			return child;
+		}
+
+		__m256 hasexp  = _mm256_cmp_ps(expnum, zero, _CMP_GT_OQ);
+		__m256 expavg  = _mm256_div_ps(_mm256_mul_ps(half, expsum), expnum);
+		__m256 val;
+		if(!userave){
+			val = _mm256_blendv_ps(fpu, expavg, hasexp);
+		}else{
+			__m256 hasrave = _mm256_cmp_ps(ravenum, zero, _CMP_GT_OQ);
+			__m256 raveavg = _mm256_div_ps(_mm256_mul_ps(half, ravesum), ravenum);
+			__m256 alpha   = _mm256_div_ps(rf, _mm256_add_ps(rf, expnum));
+			val = _mm256_add_ps(_mm256_and_ps(hasrave, _mm256_mul_ps(alpha, raveavg)),
+			                    _mm256_and_ps(hasexp,  _mm256_mul_ps(_mm256_sub_ps(one, alpha), expavg)));
+			val = _mm256_blendv_ps(fpu, val, _mm256_or_ps(hasrave, hasexp));
+		}
+
+		if(know){
+			__m256i k = _mm256_i32gather_epi32(base + KNOW_WORD, stride, 4);
+			__m256 bonus = _mm256_mul_ps(_mm256_set1_ps(0.01f), _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(k, 16), 16)));
+			__m256 few  = _mm256_cmp_ps(expnum, one, _CMP_LE_OQ);
+			__m256 some = _mm256_cmp_ps(expnum, _mm256_set1_ps(1000), _CMP_LT_OQ);
+			bonus = _mm256_blendv_ps(_mm256_and_ps(some, _mm256_div_ps(bonus, _mm256_sqrt_ps(expnum))), bonus, few);
+			val = _mm256_add_ps(val, _mm256_and_ps(_mm256_cmp_ps(bonus, zero, _CMP_GT_OQ), bonus)); //only for know > 0
+		}
+
+		if(explore > 0)
+			val = _mm256_add_ps(val, _mm256_mul_ps(expl, _mm256_sqrt_ps(_mm256_div_ps(logv, _mm256_add_ps(expnum, one)))));
+
+		//-1 for tie so any unknown is better, -2 for loss so it's even worse
+		__m256i solved = _mm256_cmpgt_epi32(outcome, _mm256_set1_epi32(-1));
+		__m256  tie    = _mm256_castsi256_ps(_mm256_cmpeq_epi32(outcome, _mm256_setzero_si256()));
+		val = _mm256_blendv_ps(val, _mm256_blendv_ps(_mm256_set1_ps(-2), _mm256_set1_ps(-1), tie), _mm256_castsi256_ps(solved));
+
+		//keep the first best per lane, like the scalar loop
+		__m256 better = _mm256_cmp_ps(val, bestval, _CMP_GT_OQ);
+		bestval = _mm256_blendv_ps(bestval, val, better);
+		bestidx = _mm256_blendv_epi8(bestidx, _mm256_add_epi32(lanes, _mm256_set1_epi32(child - begin)), _mm256_castps_si256(better));
+	}
+
+	//the best over the lanes, the lowest index on ties
+	float vals[8];
+	int idxs[8];
+	_mm256_storeu_ps(vals, bestval);
+	_mm256_storeu_si256((__m256i *) idxs, bestidx);
+	int best = -1;
+	for(int i = 0; i < 8; i++){
+		if(idxs[i] >= 0 && (best < 0 || vals[i] > vals[best] || (vals[i] == vals[best] && idxs[i] < idxs[best])))
+			best = i;
+	}
+	if(best >= 0){
+		maxval = vals[best];
+		ret = begin + idxs[best];
+	}
+
+	return child;
+}
+#endif
+
+double Player::PlayerUCT::time_choose(const Node * node, int toplay, bool simd, double len, Node * & best){
+	use_rave = true;
+	use_explore = true;
+
+	uint64_t calls = 0;
+	Time start;
+	double used;
+	do{
+		for(int i = 0; i < 1000; i++)
+			best = choose_move(node, toplay, node->children.num(), simd);
+		calls += 1000;
+		used = Time() - start;
+	}while(used < len);
+
+	return calls/used;
+}
+
 /*
 backup in this order:
 
@@ -257,8 +461,9 @@ bool Player::do_backup(Node * node, Node * backup, int toplay){
 		uint64_t sims = 0, bestsims = 0, outcome = 0, bestoutcome = 0;
 		backup = NULL;
 
-		Node * child = node->children.begin(),
-			 * end = node->children.end();
+		Node * end, * child = node->children.range(end);
+		if(child == end) //the children were just collected
+			return false;
 
 		for( ; child != end; child++){
 			int childoutcome = child->outcome; //save a copy to avoid race conditions
@@ -306,10 +511,8 @@ bool Player::do_backup(Node * node, Node * backup, int toplay){
 			return false;
 	}
 
-	if(CAS(node->outcome, nodeoutcome, backup->outcome)){
-		node->bestmove = backup->move;
-		node->proofdepth = proofdepth;
-	}else //if it was in a race, try again, might promote a partial solve to full solve
+	//publish the outcome with its proof, if it was in a race, try again, might promote a partial solve to full solve
+	if(!set_outcome(node, nodeoutcome, backup->outcome, proofdepth, backup->move))
 		return do_backup(node, backup, toplay);
 
 	return (node->outcome >= 0);
@@ -317,11 +520,17 @@ bool Player::do_backup(Node * node, Node * backup, int toplay){
 
 //update the rave score of all children that were played
 void Player::PlayerUCT::update_rave(const Node * node, int toplay){
-	Node * child = node->children.begin(),
-	     * childend = node->children.end();
+	Node * childend, * child = node->children.range(childend);
 
-	for( ; child != childend; ++child)
-		child->rave.addv(movelist.getrave(toplay, child->move));
+	const BitBoard & played = movelist.getplayed(toplay);
+	const ExpPair * rave = movelist.rave[toplay-1];
+	const Board * board = movelist.board;
+
+	for( ; child != childend; ++child){
+		int xy = board->xy(child->move);
+		if(played.test(xy)) //only moves that were played have outcomes to add
+			child->rave.addv(rave[xy]);
+	}
 }
 
 void Player::PlayerUCT::add_knowledge(Board & board, Node * node, Node * child){
@@ -353,6 +562,19 @@ void Player::PlayerUCT::add_knowledge(Board & board, Node * node, Node * child){
 
 //test whether this move is a forced reply to the opponent probing your virtual connections
 bool Player::PlayerUCT::test_bridge_probe(const Board & board, const Move & move, const Move & test) const {
+	if(move.dist(test) != 1 || !board.onboard(move))
+		return false;
+
+	int i = board.xy(move);
+	unsigned int p = (board.get(i) == 1 ? board.pattern_inv(i) : board.pattern(i)); //the replying player as 1
+	for(int d = 0; d < 6; d++)
+		if(move + neighbours[d] == test)
+			return (player->bridgeprobe[p] >> d) & 1;
+	return false;
+}
+
+//the state machine bridgeprobe was built to match, see check_bridge
+bool Player::PlayerUCT::test_bridge_probe_scan(const Board & board, const Move & move, const Move & test) const {
 	if(move.dist(test) != 1)
 		return false;
 
@@ -400,6 +622,58 @@ bool Player::PlayerUCT::test_bridge_probe(const Board & board, const Move & move
 
 
 //play a random game starting from a board state, and return the results of who won
+//split the rollouts from this leaf between this thread and its helpers, and collect their outcomes for one backup
+void Player::PlayerUCT::leaf_rollouts(const Board & board, const Move & move, int depth){
+	int num = helpers.size() + 1;
+	int share = player->rollouts / num,
+	    extra = player->rollouts % num;
+
+	leafboard = &board;
+	leafmove = move;
+	leafdepth = depth;
+	for(unsigned int h = 0; h < helpers.size(); h++)
+		helpers[h]->leafruns = share + ((int)h < extra);
+
+	leafstart.wait();
+
+	for(int i = 0; i < share; i++){
+		Board copy = board;
+		rollout(copy, move, depth);
+	}
+
+	leafend.wait();
+
+	for(unsigned int h = 0; h < helpers.size(); h++){
+		PlayerUCT * helper = helpers[h];
+		movelist.add(helper->movelist);
+
+		gamelen += helper->gamelen;
+		helper->gamelen.reset();
+		for(int a = 0; a < 2; a++){
+			for(int b = 0; b < 4; b++){
+				wintypes[a][b] += helper->wintypes[a][b];
+				helper->wintypes[a][b].reset();
+			}
+		}
+	}
+}
+
+void Player::PlayerUCT::helper_run(){
+	while(true){
+		leader->leafstart.wait();
+		if(leader->leafexit)
+			return;
+
+		movelist.copytree(leader->movelist);
+		for(int i = 0; i < leafruns; i++){
+			Board copy = *(leader->leafboard);
+			rollout(copy, leader->leafmove, leader->leafdepth);
+		}
+
+		leader->leafend.wait();
+	}
+}
+
 int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 	int won;
 	int num = board.movesremain();
@@ -407,35 +681,29 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 	bool wrand = (player->weightedrandom);
 
 	if(wrand){
-		wtree[0].resize(board.vecsize());
-		wtree[1].resize(board.vecsize());
-
-		int set = 0;
-		for(Board::MoveIterator m = board.moveit(false, false); !m.done(); ++m){
-			int i = board.xy(*m);
-			moves[i] = *m;
-			unsigned int p = board.pattern(i);
-			wtree[0].set_weight_fast(i, player->gammas[p]);
-			wtree[1].set_weight_fast(i, player->gammas[board.pattern_invert(p)]);
-			set++;
-		}
-
-		wtree[0].rebuild_tree();
-		wtree[1].rebuild_tree();
-	}else{
-		int i = 0;
-		for(Board::MoveIterator m = board.moveit(false, false); !m.done(); ++m)
-			moves[i++] = *m;
-
-		i = num;
-		while(i > 1){
-			int j = rand32() % i--;
-			Move tmp = moves[j];
-			moves[j] = moves[i];
-			moves[i] = tmp;
+		//start from the weights of the root board and only redo the cells around the tree moves, unless a swap changed them all
+		const Board & rootboard = player->rootboard;
+		bool incremental = (board.num_moves() == rootboard.num_moves() + movelist.tree);
+		for(int i = 0; incremental && i < movelist.tree; i++)
+			incremental = (movelist.moves[i] != M_SWAP);
+
+		if(incremental){
+			if(wrootmoves != rootboard.num_moves() || wroothash != rootboard.gethash()){
+				set_weights(rootboard, wroot);
+				wroothash = rootboard.gethash();
+				wrootmoves = rootboard.num_moves();
+			}
+			wtree[0].copy(wroot[0]);
+			wtree[1].copy(wroot[1]);
+			for(int i = 0; i < movelist.tree; i++){
+				int xy = board.xy(movelist.moves[i]);
+				wtree[0].set_weight(xy, 0);
+				wtree[1].set_weight(xy, 0);
+				update_weights(board, xy);
+			}
+		}else{
+			set_weights(board, wtree);
 		}
-
-//		random_shuffle(moves, moves + num);
 	}
 
 	int doinstwin = player->instwindepth;
@@ -461,7 +729,10 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 
 	int ringperm = player->ringperm;
 
-	Move * nextmove = moves;
+	//keep the wins up to date move by move instead of searching the board for them every move
+	if(player->instantwin && doinstwin > 0)
+		board.track_wins(true, (checkrings && player->instantwin != 4));
+
 	Move forced = M_UNKNOWN;
 	while((won = board.won()) < 0){
 		int turn = board.toplay();
@@ -472,6 +743,9 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 			move = pair.a;
 			forced = pair.b;
 
+			if(doinstwin <= 0 && board.tracking_wins())
+				board.track_wins(false);
+
 			//or the simple random choice if complex found nothing
 			if(move == M_UNKNOWN){
 				do{
@@ -480,10 +754,9 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 //						assert(j >= 0);
 						wtree[0].set_weight(j, 0);
 						wtree[1].set_weight(j, 0);
-						move = moves[j];
+						move = board.xymove(j);
 					}else{
-						move = *nextmove;
-						nextmove++;
+						move = board.emptymove(rand32() % board.numempty()); //uniform over the remaining moves, no shuffle needed
 					}
 				}while(!board.valid_move_fast(move));
 			}
@@ -501,17 +774,11 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 		}
 		depth++;
 		checkrings &= (depth < checkdepth);
+		if(!checkrings && board.tracking_wins())
+			board.track_wins(true, false);
 
-		if(wrand){
-			//update neighbour weights
-			for(const MoveValid * i = board.nb_begin(move), *e = board.nb_end(i); i < e; i++){
-				if(i->onboard() && board.get(i->xy) == 0){
-					unsigned int p = board.pattern(i->xy);
-					wtree[0].set_weight(i->xy, player->gammas[p]);
-					wtree[1].set_weight(i->xy, player->gammas[board.pattern_invert(p)]);
-				}
-			}
-		}
+		if(wrand)
+			update_weights(board, board.xy(move));
 	}
 
 	gamelen.add(depth);
@@ -540,89 +807,58 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 	return won;
 }
 
+//the weights of every empty cell, by its pattern, for each player
+void Player::PlayerUCT::set_weights(const Board & board, WeightedRandBuckets * w){
+	w[0].resize(board.vecsize());
+	w[1].resize(board.vecsize());
+
+	for(Board::MoveIterator m = board.moveit(false, false); !m.done(); ++m){
+		int i = board.xy(*m);
+		w[0].set_weight(i, player->gammas[board.pattern(i)]);
+		w[1].set_weight(i, player->gammas[board.pattern_inv(i)]);
+	}
+}
+
+//a stone at xy changed the patterns of its empty neighbours
+void Player::PlayerUCT::update_weights(const Board & board, int xy){
+	for(const MoveValid * i = board.nb_begin(xy), *e = board.nb_end(i); i < e; i++){
+		if(i->onboard() && board.get(i->xy) == 0){
+			wtree[0].set_weight(i->xy, player->gammas[board.pattern(i->xy)]);
+			wtree[1].set_weight(i->xy, player->gammas[board.pattern_inv(i->xy)]);
+		}
+	}
+}
+
 PairMove Player::PlayerUCT::rollout_choose_move(Board & board, const Move & prev, int & doinstwin, bool checkrings){
 	//look for instant wins
 	if(player->instantwin == 1 && --doinstwin >= 0){
-		for(Board::MoveIterator m = board.moveit(); !m.done(); ++m)
-			if(board.test_win(*m, board.toplay(), checkrings) > 0)
-				return *m;
+		int win = board.winmask(board.toplay(), checkrings).first();
+		if(win >= 0)
+			return board.xymove(win);
 	}
 
 	//look for instant wins and forced replies
 	if(player->instantwin == 2 && --doinstwin >= 0){
-		Move loss = M_UNKNOWN;
-		for(Board::MoveIterator m = board.moveit(); !m.done(); ++m){
-			if(board.test_win(*m, board.toplay(), checkrings) > 0) //win
-				return *m;
-			if(board.test_win(*m, 3 - board.toplay(), checkrings) > 0) //lose
-				loss = *m;
-		}
-		if(loss != M_UNKNOWN)
-			return loss;
+		int win = board.winmask(board.toplay(), checkrings).first();
+		if(win >= 0)
+			return board.xymove(win);
+
+		int loss = board.winmask(3 - board.toplay(), checkrings).last();
+		if(loss >= 0)
+			return board.xymove(loss);
 	}
 
+	//look for forced replies to the opponent's threats, 4 ignores rings
 	if(player->instantwin >= 3 && --doinstwin >= 0){
-		Move start, cur, loss = M_UNKNOWN;
-		int turn = 3 - board.toplay();
-
-		if(player->instantwin == 4){ //must have an edge or corner connection, or it has nothing to offer a group towards a win, ignores rings
-			const Board::Cell * c = board.cell(prev);
-			if(c->numcorners() == 0 && c->numedges() == 0)
-				goto skipinstwin3;
-
-		}
-
-//		logerr(board.to_s(true));
-
-		//find the first empty cell
-		int dir = -1;
-		for(int i = 0; i <= 5; i++){
-			start = prev + neighbours[i];
-
-			if(!board.onboard(start) || board.get(start) != turn){
-				dir = (i + 5) % 6;
-				break;
-			}
+		BitBoard threats = board.winmask(3 - board.toplay(), checkrings && player->instantwin == 3);
+		int loss = threats.first();
+		if(loss >= 0){
+			int loss2 = threats.next(loss);
+			if(loss2 >= 0)
+				return PairMove(board.xymove(loss), board.xymove(loss2)); //game over, two wins found for opponent
+			return board.xymove(loss);
 		}
-
-		if(dir == -1) //possible if it's in the middle of a ring, which is possible if rings are being ignored
-			goto skipinstwin3;
-
-		cur = start;
-
-//		logerr(prev.to_s() + ":");
-
-		//follow contour of the current group looking for wins
-		do{
-//			logerr(" " + to_str((int)cur.y) + "," + to_str((int)cur.x));
-			//check the current cell
-			if(board.onboard(cur) && board.get(cur) == 0 && board.test_win(cur, turn, checkrings) > 0){
-//				logerr(" loss");
-				if(loss == M_UNKNOWN)
-					loss = cur;
-				else if(loss != cur)
-					return PairMove(loss, cur); //game over, two wins found for opponent
-			}
-
-			//advance to the next cell
-			for(int i = 5; i <= 9; i++){
-				int nd = (dir + i) % 6;
-				Move next = cur + neighbours[nd];
-
-				if(!board.onboard(next) || board.get(next) != turn){
-					cur = next;
-					dir = nd;
-					break;
-				}
-			}
-		}while(cur != start); //potentially skips part of it when the start is in a pocket, rare bug
-
-//		logerr("\n");
-
-		if(loss != M_UNKNOWN)
-			return loss;
 	}
-skipinstwin3:
 
 	//force a bridge reply
 	if(player->rolloutpattern){
@@ -647,9 +883,20 @@ skipinstwin3:
 //would break the virtual connection, so should be played
 //a virtual connection to a wall is also important
 Move Player::PlayerUCT::rollout_pattern(const Board & board, const Move & move){
+	int a = (++rollout_pattern_offset % 6);
+	if(!board.onboard(move)) //swap
+		return M_UNKNOWN;
+
+	int i = board.xy(move);
+	unsigned int p = (board.get(i) == 1 ? board.pattern_inv(i) : board.pattern(i)); //the replying player as 1
+	int d = player->bridgereply[a][p];
+	return (d < 0 ? Move(M_UNKNOWN) : move + neighbours[d]);
+}
+
+//the state machine bridgereply was built to match, see check_bridge
+Move Player::PlayerUCT::rollout_pattern_scan(const Board & board, const Move & move, int a) const {
 	Move ret;
 	int state = 0;
-	int a = (++rollout_pattern_offset % 6);
 	int piece = 3 - board.get(move);
 	for(int i = 0; i < 8; i++){
 		Move cur = move + neighbours[(i+a)%6];
@@ -685,3 +932,64 @@ Move Player::PlayerUCT::rollout_pattern(const Board & board, const Move & move){
 	return M_UNKNOWN;
 }
 
+//the bridge replies around a probe from the pattern of its neighbours with the replying player as 1, offboard counting as
+//theirs: the empty cell in a run of theirs, empty, theirs, going around the probe from direction a. Works like the scans,
+//so the first one is what rollout_pattern_scan returns from a, and all of them from 0 are what test_bridge_probe_scan accepts
+static int bridge_scan(unsigned int p, int a, unsigned int & all){
+	int first = -1, cur = -1;
+	int state = 0;
+	all = 0;
+	for(int i = 0; i < 8; i++){
+		int d = (i+a)%6;
+		int v = (p >> 2*(5-d)) & 3;
+		bool own = (v == 1 || v == 3);
+
+		if(state == 0){
+			if(own)
+				state = 1;
+		}else if(state == 1){
+			if(v == 0){
+				state = 2;
+				cur = d;
+			}else if(v == 2)
+				state = 0;
+		}else{
+			if(own){
+				if(first < 0)
+					first = cur;
+				all |= (1 << cur);
+				state = 1;
+			}else{
+				state = 0;
+			}
+		}
+	}
+	return first;
+}
+
+void Player::set_bridge_tables(){
+	for(unsigned int p = 0; p < 4096; p++){
+		unsigned int all;
+		for(int a = 0; a < 6; a++)
+			bridgereply[a][p] = bridge_scan(p, a, all);
+		bridge_scan(p, 0, all);
+		bridgeprobe[p] = all;
+	}
+}
+
+int Player::PlayerUCT::check_bridge(const Board & board, const Move & move){
+	int errors = 0;
+	int offset = rollout_pattern_offset;
+	for(int a = 0; a < 6; a++){
+		rollout_pattern_offset = a + 5; //incremented to a
+		errors += (rollout_pattern(board, move) != rollout_pattern_scan(board, move, a));
+	}
+	rollout_pattern_offset = offset;
+
+	for(int d = 0; d < 6; d++){
+		Move test = move + neighbours[d];
+		errors += (test_bridge_probe(board, move, test) != test_bridge_probe_scan(board, move, test));
+	}
+	return errors;
+}
+
@@ -27,10 +27,37 @@ protected:
 	volatile bool timeout;
 	void timedout(){ timeout = true; }
 	Board rootboard;
+	Board::Journal journal; //lets the search make and undo moves on rootboard instead of copying it
+
+	//whether to find the immediate wins all at once with Board::winmask instead of one move at a time with test_win
+	//past 2/3 full wins are common and empty cells few, so stopping at the first win is faster, and while moves are
+	//pruned by symmetry only the loop counts the unique moves
+	static bool batchwins(const Board & board) {
+		return (board.won() < 0 && board.num_moves() > board.get_unique_depth() && board.numempty()*2 >= board.num_moves());
+	}
+
+	//how many moves the loop would have looked at before the first of wins, or all of them if there are none
+	//the pns solvers initialize proof numbers from this, so it has to count the same
+	static int movesseen(const Board & board, const BitBoard & wins) {
+		int first = wins.first();
+		return (first < 0 ? board.numempty() : board.emptymask().count_to(first));
+	}
 
 	static int solve1ply(const Board & board, int & nodes) {
 		int outcome = -3;
 		int turn = board.toplay();
+
+		if(batchwins(board)){
+			BitBoard wins = board.winmask(turn);
+			nodes += movesseen(board, wins);
+
+			if(!wins.empty())
+				return turn;
+			if(board.num_moves() + 1 == board.numcells()) //the last move, and it doesn't win
+				return 0;
+			return -3;
+		}
+
 		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
 			++nodes;
 			int won = board.test_win(*move, turn);
@@ -47,6 +74,20 @@ protected:
 		int losses = 0;
 		int outcome = -3;
 		int turn = board.toplay(), opponent = 3 - turn;
+
+		if(batchwins(board)){
+			BitBoard wins = board.winmask(turn);
+			nodes += movesseen(board, wins);
+
+			if(!wins.empty())
+				return turn;
+			if(board.winmask(opponent).count() >= 2) //can only block one of them
+				return opponent;
+			if(board.num_moves() + 1 == board.numcells())
+				return 0;
+			return -3;
+		}
+
 		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
 			++nodes;
 			int won = board.test_win(*move, turn);
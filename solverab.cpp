@@ -20,6 +20,8 @@ void SolverAB::solve(double time){
 
 	int turn = rootboard.toplay();
 
+	rootboard.set_journal(&journal);
+
 	for(maxdepth = startdepth; !timeout; maxdepth++){
 //		logerr("Starting depth " + to_str(maxdepth) + "\n");
 
@@ -28,10 +30,9 @@ void SolverAB::solve(double time){
 		for(Board::MoveIterator move = rootboard.moveit(true); !move.done(); ++move){
 			nodes_seen++;
 
-			Board next = rootboard;
-			next.move(*move, true, false);
-
-			int value = -negamax(next, maxdepth - 1, -beta, -alpha);
+			rootboard.move(*move, true, false);
+			int value = -negamax(rootboard, maxdepth - 1, -beta, -alpha);
+			rootboard.undo();
 
 			if(value > alpha){
 				alpha = value;
@@ -55,11 +56,14 @@ void SolverAB::solve(double time){
 		}
 	}
 
+	rootboard.set_journal(NULL);
+
 	time_used = Time() - start;
 }
 
 
-int SolverAB::negamax(const Board & board, const int depth, int alpha, int beta){
+//board must have a journal attached, moves are made and undone in place
+int SolverAB::negamax(Board & board, const int depth, int alpha, int beta){
 	if(board.won() >= 0)
 		return (board.won() ? -2 : -1);
 
@@ -74,21 +78,24 @@ int SolverAB::negamax(const Board & board, const int depth, int alpha, int beta)
 		nodes_seen++;
 
 		hash_t hash = board.test_hash(*move);
+		tt_probes++;
 		if(int ttval = tt_get(hash)){
 			value = ttval;
-		}else if(depth <= 2){
+			tt_hits++;
+		}else if(depth <= 2){ //one move at a time rather than Board::winmask, most of these nodes cut off after a move or two
 			value = lookup[board.test_win(*move)+3];
 
 			if(board.test_win(*move, 3 - board.toplay()) > 0)
 				losses++;
 		}else{
-			Board next = board;
-			next.move(*move, true, false);
+			board.move(*move, true, false);
 
-			value = -negamax(next, depth - 1, -b, -alpha);
+			value = -negamax(board, depth - 1, -b, -alpha);
 
 			if(scout && value > alpha && value < beta && !first) // re-search
-				value = -negamax(next, depth - 1, -beta, -alpha);
+				value = -negamax(board, depth - 1, -beta, -alpha);
+
+			board.undo();
 		}
 		tt_set(hash, value);
 
@@ -111,7 +118,9 @@ int SolverAB::negamax(const Board & board, const int depth, int alpha, int beta)
 }
 
 int SolverAB::negamax_outcome(const Board & board, const int depth){
-	int abval = negamax(board, depth, -2, 2);
+	Board copy = board;
+	copy.set_journal(&journal);
+	int abval = negamax(copy, depth, -2, 2);
 	if(     abval == 0)  return -3; //unknown
 	else if(abval == 2)  return board.toplay(); //win
 	else if(abval == -2) return 3 - board.toplay(); //loss
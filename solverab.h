@@ -18,6 +18,7 @@ public:
 
 	ABTTNode * TT;
 	uint64_t maxnodes, memlimit;
+	uint64_t tt_probes, tt_hits; //how often negamax found a child in the TT, since the last reset
 
 	SolverAB(bool Scout = false) {
 		scout = Scout;
@@ -53,6 +54,8 @@ public:
 		maxdepth = 0;
 		nodes_seen = 0;
 		time_used = 0;
+		tt_probes = 0;
+		tt_hits = 0;
 		bestmove = Move(M_UNKNOWN);
 
 		timeout = false;
@@ -61,7 +64,7 @@ public:
 	void solve(double time);
 
 //return -2 for loss, -1,1 for tie, 0 for unknown, 2 for win, all from toplay's perspective
-	int negamax(const Board & board, const int depth, int alpha, int beta);
+	int negamax(Board & board, const int depth, int alpha, int beta);
 	int negamax_outcome(const Board & board, const int depth);
 
 	int tt_get(const hash_t & hash);
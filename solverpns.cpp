@@ -18,7 +18,32 @@ void SolverPNS::solve(double time){
 //	logerr("max nodes: " + to_str(memlimit/sizeof(PNSNode)) + ", max memory: " + to_str(memlimit/(1024*1024)) + " Mb\n");
 
 	run_pns();
+	root_outcome();
 
+	time_used = Time() - start;
+}
+
+//search until solved, out of memory, or stopped, without the alarm or the garbage collection of solve
+//alarms are only safe in the main thread, so this is the way to solve in other threads, and stop can be called from any thread
+void SolverPNS::solve_mem(){
+	if(rootboard.won() >= 0){
+		outcome = rootboard.won();
+		return;
+	}
+
+	Time start;
+
+	rootboard.set_journal(&journal);
+	while(!timeout && root.phi != 0 && root.delta != 0 && pns(rootboard, &root, 0, INF32/2, INF32/2))
+		;
+	rootboard.set_journal(NULL);
+
+	root_outcome();
+
+	time_used = Time() - start;
+}
+
+void SolverPNS::root_outcome(){
 	if(root.phi == 0 && root.delta == LOSS){ //look for the winning move
 		for(PNSNode * i = root.children.begin() ; i != root.children.end(); i++){
 			if(i->delta == 0){
@@ -42,11 +67,11 @@ void SolverPNS::solve(double time){
 		bestmove = M_UNKNOWN;
 		outcome = -3;
 	}
-
-	time_used = Time() - start;
 }
 
 void SolverPNS::run_pns(){
+	rootboard.set_journal(&journal);
+
 	while(!timeout && root.phi != 0 && root.delta != 0){
 		if(!pns(rootboard, &root, 0, INF32/2, INF32/2)){
 			logerr("Starting solver GC with limit " + to_str(gclimit) + " ... ");
@@ -67,9 +92,12 @@ void SolverPNS::run_pns(){
 				gclimit = (unsigned int)(gclimit*0.9); //slowly decay to a minimum of 5
 		}
 	}
+
+	rootboard.set_journal(NULL);
 }
 
-bool SolverPNS::pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
+//board must have a journal attached, moves are made and undone in place
+bool SolverPNS::pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
 	iters++;
 	if(maxdepth < depth)
 		maxdepth = depth;
@@ -89,12 +117,13 @@ bool SolverPNS::pns(const Board & board, PNSNode * node, int depth, uint32_t tp,
 			int outcome, pd;
 
 			if(ab){
-				Board next = board;
-				next.move(*move, false, false);
+				board.move(*move, false, false);
 
 				pd = 0;
-				outcome = (ab == 1 ? solve1ply(next, pd) : solve2ply(next, pd));
+				outcome = (ab == 1 ? solve1ply(board, pd) : solve2ply(board, pd));
 				nodes_seen += pd;
+
+				board.undo();
 			}else{
 				outcome = board.test_win(*move);
 				pd = 1;
@@ -142,13 +171,14 @@ bool SolverPNS::pns(const Board & board, PNSNode * node, int depth, uint32_t tp,
 				child++;
 		}
 
-		Board next = board;
-		next.move(child->move, false, false);
+		board.move(child->move, false, false);
 
 		uint64_t itersbefore = iters;
-		mem = pns(next, child, depth + 1, tpc, tdc);
+		mem = pns(board, child, depth + 1, tpc, tdc);
 		child->work += iters - itersbefore;
 
+		board.undo();
+
 		if(child->phi == 0 || child->delta == 0) //clear child's children
 			nodes -= child->dealloc(ctmem);
 
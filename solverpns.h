@@ -193,10 +193,13 @@ public:
 	}
 
 	void solve(double time);
+	void solve_mem(); //solve in any thread, within memlimit, timeout is not reset
+	void stop(){ timedout(); }
+	void root_outcome(); //set outcome and bestmove from the root
 
 //basic proof number search building a tree
 	void run_pns();
-	bool pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
+	bool pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
 
 //update the phi and delta for the node
 	bool updatePDnum(PNSNode * node);
@@ -14,6 +14,8 @@ void SolverPNSTT::solve(double time){
 	Alarm timer(time, std::tr1::bind(&SolverPNSTT::timedout, this));
 	Time start;
 
+	rootboard.set_journal(&journal);
+
 //	logerr("max nodes: " + to_str(maxnodes) + ", max memory: " + to_str(memlimit) + " Mb\n");
 
 	run_pns();
@@ -46,6 +48,8 @@ void SolverPNSTT::solve(double time){
 		outcome = -3;
 	}
 
+	rootboard.set_journal(NULL);
+
 	time_used = Time() - start;
 }
 
@@ -57,7 +61,8 @@ void SolverPNSTT::run_pns(){
 		pns(rootboard, &root, 0, INF32/2, INF32/2);
 }
 
-void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
+//board must have a journal attached, moves are made and undone in place
+void SolverPNSTT::pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
 	if(depth > maxdepth)
 		maxdepth = depth;
 
@@ -94,26 +99,32 @@ void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t t
 				tpc = tdc = 0;
 			}
 
-			Board next = board;
-			next.move(move1);//, false, false);
-			pns(next, child, depth + 1, tpc, tdc);
+			board.move(move1);//, false, false);
+			pns(board, child, depth + 1, tpc, tdc);
 
 			//just found a loss, try to copy proof to siblings
 			if(copyproof && child->delta == LOSS){
 //				logerr("!" + move1.to_s() + " ");
+				Board next = board; //the proof lives under move1 while the siblings are played on board
+				next.set_journal(&proofjournal);
+				board.undo();
+
 				int count = abs(copyproof);
 				for(Board::MoveIterator move = board.moveit(true); count-- && !move.done(); ++move){
 					if(!tt(board, *move)->terminal()){
 //						logerr("?" + move->to_s() + " ");
-						Board sibling = board;
-						sibling.move(*move);
-						copy_proof(next, sibling, move1, *move);
-						updatePDnum(sibling);
+						board.move(*move);
+						copy_proof(next, board, move1, *move);
+						updatePDnum(board);
 
-						if(copyproof < 0 && !tt(sibling)->terminal())
+						bool stop = (copyproof < 0 && !tt(board)->terminal());
+						board.undo();
+						if(stop)
 							break;
 					}
 				}
+			}else{
+				board.undo();
 			}
 		}
 
@@ -123,7 +134,7 @@ void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t t
 	}while(!timeout && node->phi && node->delta && (!df || (node->phi < tp && node->delta < td)));
 }
 
-bool SolverPNSTT::updatePDnum(const Board & board, PNSNode * node){
+bool SolverPNSTT::updatePDnum(Board & board, PNSNode * node){
 	hash_t hash = board.gethash();
 
 	if(node == NULL)
@@ -166,7 +177,8 @@ bool SolverPNSTT::updatePDnum(const Board & board, PNSNode * node){
 //source is a move that is a proven loss, and dest is an unproven sibling
 //each has one move that the other doesn't, which are stored in smove and dmove
 //if either move is used but only available in one board, the other is substituted
-void SolverPNSTT::copy_proof(const Board & source, const Board & dest, Move smove, Move dmove){
+//both boards need a journal, and are back in their original positions on return
+void SolverPNSTT::copy_proof(Board & source, Board & dest, Move smove, Move dmove){
 	if(timeout || tt(source)->delta != LOSS || tt(dest)->terminal())
 		return;
 
@@ -182,52 +194,63 @@ void SolverPNSTT::copy_proof(const Board & source, const Board & dest, Move smov
 	if(bestmove == M_UNKNOWN) //due to transposition table collision
 		return;
 
-	Board dest2 = dest;
-
+	bool valid;
 	if(bestmove == dmove){
-		assert(dest2.move(smove));
+		valid = dest.move(smove);
 		smove = dmove = M_UNKNOWN;
 	}else{
-		assert(dest2.move(bestmove));
+		valid = dest.move(bestmove);
 		if(bestmove == smove)
 			smove = dmove = M_UNKNOWN;
 	}
+	assert(valid);
 
-	if(tt(dest2)->terminal())
+	if(tt(dest)->terminal()){
+		dest.undo();
 		return;
+	}
 
-	Board source2 = source;
-	assert(source2.move(bestmove));
+	valid = source.move(bestmove);
+	assert(valid);
 
-	if(source2.won() >= 0)
+	if(source.won() >= 0){
+		source.undo();
+		dest.undo();
 		return;
+	}
 
 	//test all responses
-	for(Board::MoveIterator move = dest2.moveit(true); !move.done(); ++move){
-		if(tt(dest2, *move)->terminal())
+	for(Board::MoveIterator move = dest.moveit(true); !move.done(); ++move){
+		if(tt(dest, *move)->terminal())
 			continue;
 
 		Move csmove = smove, cdmove = dmove;
 
-		Board source3 = source2, dest3 = dest2;
-
 		if(*move == csmove){
-			assert(source3.move(cdmove));
+			valid = source.move(cdmove);
 			csmove = cdmove = M_UNKNOWN;
 		}else{
-			assert(source3.move(*move));
+			valid = source.move(*move);
 			if(*move == csmove)
 				csmove = cdmove = M_UNKNOWN;
 		}
+		assert(valid);
+
+		valid = dest.move(*move);
+		assert(valid);
 
-		assert(dest3.move(*move));
+		copy_proof(source, dest, csmove, cdmove);
 
-		copy_proof(source3, dest3, csmove, cdmove);
+		updatePDnum(dest);
 
-		updatePDnum(dest3);
+		dest.undo();
+		source.undo();
 	}
 
-	updatePDnum(dest2);
+	updatePDnum(dest);
+
+	source.undo();
+	dest.undo();
 }
 
 SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board){
@@ -235,7 +258,10 @@ SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board){
 
 	PNSNode * node = TT + (hash % maxnodes);
 
-	if(node->hash != hash){
+	tt_probes++;
+	if(node->hash == hash)
+		tt_hits++;
+	else{
 		int outcome, pd;
 
 		if(ab){
@@ -254,20 +280,23 @@ SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board){
 	return node;
 }
 
-SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board, Move move){
+SolverPNSTT::PNSNode * SolverPNSTT::tt(Board & board, Move move){
 	hash_t hash = board.test_hash(move, board.toplay());
 
 	PNSNode * node = TT + (hash % maxnodes);
 
-	if(node->hash != hash){
+	tt_probes++;
+	if(node->hash == hash)
+		tt_hits++;
+	else{
 		int outcome, pd;
 
 		if(ab){
-			Board next = board;
-			next.move(move);//, false, false);
+			board.move(move);//, false, false);
 			pd = 0;
-			outcome = (ab == 1 ? solve1ply(next, pd) : solve2ply(next, pd));
+			outcome = (ab == 1 ? solve1ply(board, pd) : solve2ply(board, pd));
 			nodes_seen += pd;
+			board.undo();
 		}else{
 			outcome = board.test_win(move);
 			pd = 1;
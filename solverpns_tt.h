@@ -49,6 +49,7 @@ public:
 	PNSNode root;
 	PNSNode * TT;
 	uint64_t maxnodes, memlimit;
+	uint64_t tt_probes, tt_hits; //how often tt() found the node already there, since the last reset
 
 	int   ab; // how deep of an alpha-beta search to run at each leaf node
 	bool  df; // go depth first?
@@ -56,6 +57,8 @@ public:
 	int   ties;    //which player to assign ties to: 0 handle ties, 1 assign p1, 2 assign p2
 	int   copyproof; //how many siblings to try to copy a proof to
 
+	Board::Journal proofjournal; //for the second board copy_proof walks alongside rootboard
+
 
 	SolverPNSTT() {
 		ab = 2;
@@ -82,6 +85,8 @@ public:
 		maxdepth = 0;
 		nodes_seen = 0;
 		time_used = 0;
+		tt_probes = 0;
+		tt_hits = 0;
 		bestmove = Move(M_UNKNOWN);
 
 		timeout = false;
@@ -118,14 +123,14 @@ public:
 
 //basic proof number search building a tree
 	void run_pns();
-	void pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
+	void pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
 
-	void copy_proof(const Board & source, const Board & dest, Move smove, Move dmove);
+	void copy_proof(Board & source, Board & dest, Move smove, Move dmove);
 
 //update the phi and delta for the node
-	bool updatePDnum(const Board & board, PNSNode * node = NULL);
+	bool updatePDnum(Board & board, PNSNode * node = NULL);
 
 	PNSNode * tt(const Board & board);
-	PNSNode * tt(const Board & board, Move move);
+	PNSNode * tt(Board & board, Move move);
 };
 
@@ -0,0 +1,8 @@
+bench_board 4
+bench_board 5
+bench_board 6
+bench_board 7
+bench_board 8
+bench_board 9
+bench_board 10
+quit
@@ -0,0 +1,5 @@
+# the fixed benchmark, single threaded then with 4 threads, output as JSON
+# with one thread everything but the times should match from run to run, compare them after a change to the search
+player_params --seed 1
+benchmark 20000 4
+quit
@@ -0,0 +1,315 @@
+# ring check throughput, random games finished from ring heavy positions
+# the positions from test/assign1/ring*.tst just before their ring, then the empty board
+gridcoords
+boardsize 4
+play w d2
+play b c2
+play w c1
+play b c3
+play w b1
+play b d3
+play w b2
+play b c4
+play w b3
+play b d4
+play w b4
+play b d5
+play w c5
+play b a3
+play w b5
+play b a2
+play w d6
+play b a4
+play w e5
+play b e6
+play w e4
+play b e3
+play w f4
+play b g3
+play w f3
+play b g2
+play w f2
+play b g1
+play w c6
+play b f5
+play w d7
+play b f1
+bench_rings 1
+boardsize 10
+play w p9
+play b n8
+play w l11
+play b i12
+play w g7
+play b j7
+play w o5
+play b q4
+play w n10
+play b l13
+play w l16
+play b e11
+play w h9
+play b l5
+play w h7
+play b e8
+play w c4
+play b h5
+play w m8
+play b p7
+play w q8
+play b m12
+play w g15
+play b e10
+play w o7
+play b i7
+play w h2
+play b o4
+play w o2
+play b k6
+play w i13
+play b i10
+play w n5
+play b q5
+play w j13
+play b j17
+play w f13
+play b c9
+play w a5
+play b f4
+play w i4
+play b l3
+play w k9
+play b p10
+play w p11
+play b k14
+play w h14
+play b f10
+play w j10
+play b o8
+play w f5
+play b e6
+play w g10
+play b h11
+play w g12
+play b j15
+play w n14
+play b o11
+play w m10
+play b j12
+play w h12
+play b e7
+play w k5
+play b m4
+play w o3
+play b r3
+play w n7
+play b k8
+play w l10
+play b k11
+play w h15
+play b e12
+play w d10
+play b d7
+play w b4
+play b d4
+play w f3
+play b j4
+play w k3
+play b p1
+play w l7
+play b o9
+play w p8
+play b l12
+play w k13
+play b k15
+play w n13
+play b s10
+play w r7
+play b r6
+play w g3
+play b e1
+play w c1
+play b b2
+play w b6
+play b b8
+play w d11
+play b i16
+play w h16
+play b d12
+play w a9
+play b a7
+play w a3
+play b c2
+play w e2
+play b k1
+play w l1
+play b n2
+play w s2
+play b s5
+play w s7
+play b s8
+play w q10
+play b q11
+play w o12
+play b m14
+play w j16
+play b i15
+play w k16
+play b n11
+play w n12
+play b o10
+play w m11
+play b n9
+play w q7
+play b q6
+play w l15
+play b k12
+play w p2
+play b g11
+play w f6
+play b e9
+play w e5
+play b d5
+play w e4
+play b d3
+play w g5
+play b e3
+play w g6
+play b h6
+play w h4
+play b g4
+play w m9
+play b j8
+play w l9
+play b l8
+play w k10
+play b j11
+play w j9
+play b g8
+play w i9
+play b g9
+play w h8
+play b f8
+play w i8
+play b i11
+play w h10
+play b f7
+play w f9
+play b c6
+play w d6
+play b b5
+play w c5
+play b c3
+play w a4
+play b d2
+play w n4
+play b n3
+play w p3
+play b o1
+play w r1
+play b q1
+play w r2
+play b q2
+play w p5
+play b q3
+undo
+play b p6
+play w o6
+play b n6
+play w m6
+play b m7
+play w l6
+play b k7
+play w m5
+play b j14
+play w i14
+play b g13
+play w h13
+play b g14
+play w f11
+play b f12
+play w f14
+play b e13
+play w d9
+play b d8
+play w c8
+play b c7
+play w b7
+play b a6
+play w c10
+play b c11
+play w c12
+play b f15
+play w e14
+play b b10
+play w d13
+play b a10
+play w b11
+play b a8
+play w b9
+play b g16
+play w h17
+play b i17
+play w i18
+play b j18
+play w j19
+play b k17
+play w k18
+play b m16
+play w l17
+play b m15
+play w l14
+play b n15
+play w m13
+play b q9
+play w r9
+play b r8
+play w r10
+play b r11
+play w p13
+play b o14
+play w o13
+play b p12
+play w q12
+play b s6
+play w s4
+play b r5
+play w s3
+play b r4
+play w n1
+play b p4
+play w m1
+play b m2
+play w l4
+play b m3
+play w k4
+play b f2
+play w a1
+play b f1
+play w a2
+play b g2
+play w b3
+play b g1
+play w h3
+play b j3
+play w i3
+play b j2
+play w k2
+play b j1
+play w l2
+play b j5
+play w j6
+play b i6
+play w s1
+play b i1
+play w i2
+play b h1
+play w d1
+bench_rings 1
+bench_rings 1 8
+bench_rings 1 6 1
+boardsize 10
+bench_rings 1
+bench_rings 1 8
+hguicoords
+quit
@@ -0,0 +1,74 @@
+# solver throughput, nodes/s is logged after each solve
+# the positions from test/solver plus the empty board, where the symmetry pruning matters most
+hguicoords
+boardsize 4
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 8
+playgame h3 i13 g2 h11 h1 j12 g1 g12 f3 j13 g11 f2 g3 k14 d2 h10 j11 a1 c3 i2 j4 h14 i14 l13 m13 m14 m15 o15 h15 o14 b3
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 4
+playgame g4 a4 g7 f5 a1 d2 c3 d7 b5 c4 b4 b3 g6
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+gridcoords
+boardsize 4
+playgame d1 a1 g1 e2 g4 f3 a4 d7 c4 f4 f5 e5 e6 d6 c2 e1 c3
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 5
+playgame h6 i9 e9 a5 a1 e1 g7 h5 f3 g5 i6 i5 e4 e5 g8 f5 b5 d4 d8 d3 e2 f9 b3 b4 a4 c1 d1 a3 c4 c5 d5 d6 e6 a2 b2 e7 c7 b1 d2 c2 e8 f8 h7 g4 i8 h8 f2 g9 e3 h9 f6 g3 c6 h4 d7 f4 b6 i7 g6 c3 f7
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 4
+playgame a4 g4 a1 b3 g7 d1 d7 f3 e2 d2
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 4
+playgame g4 a4 g7 f5 a1 d2 c3 d7 b5 c4 b4 b3
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 4
+playgame g5 d1 g4 g7 e3 c2 a1 a4 f5 f3 d7 d6 c3
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+hguicoords
+boardsize 4
+playgame b1 d2 a2 e4
+ab_solve 2
+pns_solve 2
+pns_clear
+pnstt_solve 2
+pnstt_clear
+quit
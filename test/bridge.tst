@@ -0,0 +1,3 @@
+# the bridge reply tables used by the rollouts and the knowledge against the scans they replace, should find no differences
+check_bridge
+quit
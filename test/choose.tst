@@ -0,0 +1,11 @@
+# choosing a child with and without simd, on a node with made up stats for every move
+# each line reports calls/s for both and fails if they pick different children
+boardsize 4
+bench_choose 2
+boardsize 8
+bench_choose 2
+boardsize 10
+bench_choose 2
+player_params -e 0 -a 0
+bench_choose 2
+quit
@@ -0,0 +1,12 @@
+# garbage collection under memory pressure, with and without collecting while searching
+# compare the pause histograms from player_gcstats, the stress test fails if collecting broke the tree
+boardsize 8
+player_params -M 20 -t 4
+genmove 10
+player_gcstats
+player_stress 16 10
+player_gcstats reset
+player_params --gcconc 0
+genmove 10
+player_gcstats
+quit
@@ -0,0 +1,16 @@
+# eviction by experience alone and by recency, under memory pressure over a few moves
+# compare how much of what each collection kept was walked through again, and the pauses, from player_gcstats
+boardsize 8
+player_params -M 20 -t 4 --gcdecay 1
+genmove 5
+genmove 5
+genmove 5
+player_gcstats
+player_gcstats reset
+clear_board
+player_params --gcdecay 0.5
+genmove 5
+genmove 5
+genmove 5
+player_gcstats
+quit
@@ -0,0 +1,23 @@
+# runs/s and tree depth with several rollouts per leaf, run by the thread alone or shared with helper threads
+# the genmove stats report both, 5 seconds per search from the empty size 6 board
+boardsize 6
+time -g 0 -m 0 -i 0
+player_params -t 4 -O 1 --leafpar 0
+genmove w 5
+undo
+player_params -t 4 -O 4 --leafpar 0
+genmove w 5
+undo
+player_params -t 4 -O 4 --leafpar 3
+genmove w 5
+undo
+player_params -t 4 -O 16 --leafpar 0
+genmove w 5
+undo
+player_params -t 4 -O 16 --leafpar 3
+genmove w 5
+undo
+player_params -t 4 -O 16 --leafpar 15
+genmove w 5
+undo
+quit
@@ -0,0 +1,8 @@
+# bytes per node and how many fit in maxmem, before and after a search fills the tree
+# build with make COMPACT=1 to compare the 24 byte nodes against the default 32
+boardsize 10
+player_mem
+player_mem 4000
+genmove 10
+player_mem
+quit
@@ -0,0 +1,19 @@
+# proving a late position with and without prover threads
+# compare the runs it took until "Solved as", and the proofs the provers found, the stress test checks the proofs fit the tree
+boardsize 4
+play b d4
+play w c3
+play b e5
+play w d3
+play b c4
+play w e4
+play b d5
+time -m 30 -g 0
+player_params -t 1 --provers 0
+genmove
+undo
+player_params --provers 1 --provemin 200 --provemem 8
+genmove
+undo
+player_stress 4 5
+quit
@@ -0,0 +1,22 @@
+# runs/s of one shared tree against root parallelization, 5 seconds per search from the empty size 8 board
+# for playing strength per wall second play them against each other with the same time, e.g.
+#   ./tournament.rb -a -s 8 -t 5 -r 50 "./castro -c 'player_params -t 32'" "./castro -c 'player_params -t 32 -j 32 --rootsync 100'"
+boardsize 8
+time -g 0 -m 0 -i 0
+player_params -t 16 -j 0
+player_solve 5
+player_params -t 16 -j 16
+player_solve 5
+player_params -t 16 -j 16 --rootsync 100
+player_solve 5
+player_params -t 32 -j 0
+player_solve 5
+player_params -t 32 -j 32 --rootsync 100
+player_solve 5
+player_params -t 32 -j 8 --rootsync 100
+player_solve 5
+player_params -t 64 -j 0
+player_solve 5
+player_params -t 64 -j 64 --rootsync 100
+player_solve 5
+quit
@@ -0,0 +1,13 @@
+# many threads sharing one tree on small boards, every node checked afterwards
+# each line reports runs/s and fails if any node's stats or proof are inconsistent
+boardsize 4
+player_stress 32 5
+player_stress 64 5
+clear_board
+player_params -m 2
+player_stress 32 5
+boardsize 5
+player_params -m 1
+player_stress 32 5
+player_stress 64 5
+quit
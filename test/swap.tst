@@ -0,0 +1,10 @@
+# swapping gives white's first stone to black, whose moves next to it must join its group
+# compare the swap line of move_stats: black wins about 75% of the sims through the swap, 67% when the stones don't join
+boardsize 3
+swap 1
+play w a1
+player_params -t 1 -m 1
+time -m 20 -g 0
+player_solve
+move_stats
+quit
@@ -0,0 +1,3 @@
+# weighted random games on sizes 5 to 10 with the old tree and the buckets the rollouts use now
+bench_wrand 1
+quit
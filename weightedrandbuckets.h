@@ -0,0 +1,191 @@
+
+#pragma once
+
+/*
+Given weights for indexes, returns a random index according to the weights.
+Same use as WeightedRandTree, but with O(1) updates and O(1) expected choose.
+
+The weights are rounded to 16.16 fixed point, so the sums are exact, and each index
+goes in the bucket for the highest bit of its weight. Choose picks a bucket by its sum,
+then an index in it uniformly, keeping it with probability weight/2^(bucket+1), which
+is at least 1/2 since every weight in the bucket is within a factor of 2 of the others.
+Weights at or below 0.0001 are treated as 0, like WeightedRandTree skips them.
+*/
+
+#include <stdint.h>
+#include <cstring>
+#include "xorshift.h"
+
+class WeightedRandBuckets {
+	static const int numbuckets = 32;
+
+	mutable XORShift_uint32 rand32;
+	unsigned int size, allocsize;
+	uint32_t * weights; //fixed point weight per index
+	uint16_t * slot;    //position of each index in its bucket
+	uint16_t * members; //numbuckets lists of allocsize indexes
+	uint16_t counts[numbuckets];
+	uint64_t sums[numbuckets];
+	uint64_t total;
+	uint32_t used;      //bit per non-empty bucket
+
+	static int bucket(uint32_t q) { return 31 - __builtin_clz(q); }
+
+	void add(unsigned int i, uint32_t q){
+		int b = bucket(q);
+		slot[i] = counts[b];
+		members[b*allocsize + counts[b]++] = i;
+		sums[b] += q;
+		total += q;
+		used |= (1u << b);
+	}
+
+	void remove(unsigned int i, uint32_t q){
+		int b = bucket(q);
+		uint16_t * list = members + b*allocsize;
+		uint16_t last = list[--counts[b]];
+		list[slot[i]] = last;
+		slot[last] = slot[i];
+		sums[b] -= q;
+		total -= q;
+		if(counts[b] == 0)
+			used &= ~(1u << b);
+	}
+
+	WeightedRandBuckets(const WeightedRandBuckets &);
+	WeightedRandBuckets & operator = (const WeightedRandBuckets &);
+public:
+	WeightedRandBuckets()      : size(0), allocsize(0), weights(NULL), slot(NULL), members(NULL) { clear(); }
+	WeightedRandBuckets(unsigned int s) : size(0), allocsize(0), weights(NULL), slot(NULL), members(NULL) { resize(s); }
+
+	~WeightedRandBuckets(){
+		free();
+	}
+
+	void free(){
+		if(weights){
+			delete[] weights;
+			delete[] slot;
+			delete[] members;
+		}
+		weights = NULL;
+		slot = NULL;
+		members = NULL;
+		allocsize = 0;
+	}
+
+	//resize and clear, O(s)
+	void resize(unsigned int s){
+		size = s;
+
+		if(size > allocsize){
+			free();
+			allocsize = size;
+			weights = new uint32_t[allocsize];
+			slot    = new uint16_t[allocsize];
+			members = new uint16_t[allocsize*numbuckets];
+		}
+
+		clear();
+	}
+
+	//reset all weights to 0, O(s)
+	void clear(){
+		for(unsigned int i = 0; i < size; i++)
+			weights[i] = 0;
+		for(int b = 0; b < numbuckets; b++){
+			counts[b] = 0;
+			sums[b] = 0;
+		}
+		total = 0;
+		used = 0;
+	}
+
+	//start from the weights of another one, like a board state this one's is derived from, O(s)
+	void copy(const WeightedRandBuckets & o){
+		if(o.size > allocsize){
+			free();
+			allocsize = o.size;
+			weights = new uint32_t[allocsize];
+			slot    = new uint16_t[allocsize];
+			members = new uint16_t[allocsize*numbuckets];
+		}
+		size = o.size;
+
+		memcpy(weights, o.weights, size*sizeof(uint32_t));
+		memcpy(slot, o.slot, size*sizeof(uint16_t));
+		for(int b = 0; b < numbuckets; b++){
+			counts[b] = o.counts[b];
+			sums[b] = o.sums[b];
+			if(counts[b])
+				memcpy(members + b*allocsize, o.members + b*o.allocsize, counts[b]*sizeof(uint16_t));
+		}
+		total = o.total;
+		used = o.used;
+	}
+
+	//the random numbers for choose, each thread seeds its own so they don't all make the same choices
+	void seed(uint32_t s){
+		rand32.seed(s);
+	}
+
+	static uint32_t quantize(float w){
+		if(w <= 0.0001f)
+			return 0;
+		if(w >= 65535.f)
+			return 0xFFFFFFFFu;
+		return (uint32_t)(w*65536.f + 0.5f);
+	}
+
+	//get an individual weight, as rounded, O(1)
+	float get_weight(unsigned int i) const {
+		return weights[i] / 65536.f;
+	}
+
+	//get the sum of the weights, O(1)
+	float sum_weight() const {
+		return total / 65536.f;
+	}
+
+	//sets the weight, O(1)
+	void set_weight(unsigned int i, float w){
+		uint32_t q = quantize(w);
+		uint32_t old = weights[i];
+
+		if(q == old)
+			return;
+
+		if(old)
+			remove(i, old);
+		if(q)
+			add(i, q);
+		weights[i] = q;
+	}
+
+	//return a weighted random index, O(1) expected, -1 if all the weights are 0
+	int choose() const {
+		if(total == 0)
+			return -1;
+
+		//the bucket, from the heaviest, by a number in [0, total)
+		uint64_t r = (uint64_t)(total * (rand32() * (1.0 / 4294967296.0)));
+		int b;
+		uint32_t left = used;
+		while(true){
+			b = bucket(left);
+			left &= ~(1u << b);
+			if(r < sums[b] || left == 0) //rounding can leave r just past the end
+				break;
+			r -= sums[b];
+		}
+
+		//an index within it, kept in proportion to its weight
+		const uint16_t * list = members + b*allocsize;
+		uint32_t mask = (uint32_t)((2ULL << b) - 1);
+		while(true){
+			int i = list[((uint64_t)counts[b] * rand32()) >> 32];
+			if((rand32() & mask) < weights[i])
+				return i;
+		}
+	}
+};
@@ -1,9 +1,12 @@
-
 #pragma once
 
 //Maintains 12 zobrist hashes, one for each permutation
+//The 12 are kept side by side so a stone can be xored into all of them at once, 4 per AVX2 register.
 
 #include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 typedef uint64_t hash_t;
 
@@ -13,6 +16,24 @@ private:
 
 	hash_t values[12];
 
+#ifdef __AVX2__
+	//AVX2 has no unsigned 64bit compare, so flip the top bit and compare signed
+	static __m256i flip(__m256i a){ return _mm256_xor_si256(a, _mm256_set1_epi64x((long long)(1ULL << 63))); }
+	static __m256i min4(__m256i a, __m256i b){ return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+	static __m128i min2(__m128i a, __m128i b){ return _mm_blendv_epi8(a, b, _mm_cmpgt_epi64(a, b)); }
+
+	//min of the 12 hashes in a,b,c, which have already been flipped
+	static hash_t min12(__m256i a, __m256i b, __m256i c){
+		a = min4(min4(a, b), c);
+		__m128i m = min2(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+		m = min2(m, _mm_unpackhi_epi64(m, m));
+		return (hash_t)_mm_cvtsi128_si64(m) ^ (1ULL << 63);
+	}
+
+	__m256i load(int i) const { return _mm256_loadu_si256((const __m256i *)(values + i)); }
+	static __m256i load(const hash_t * keys, int i) { return _mm256_loadu_si256((const __m256i *)(keys + i)); }
+#endif
+
 public:
 	Zobrist(){
 		for(int i = 0; i < 12; i++)
@@ -33,12 +54,40 @@ public:
 		return values[permutation];
 	}
 
+	//the min over all permutations after xoring in keys, one key per permutation, see BoardTables::zobrist
+	hash_t test(const hash_t * keys) const {
+#ifdef __AVX2__
+		return min12(flip(_mm256_xor_si256(load(0), load(keys, 0))),
+		             flip(_mm256_xor_si256(load(4), load(keys, 4))),
+		             flip(_mm256_xor_si256(load(8), load(keys, 8))));
+#else
+		hash_t m = values[0] ^ keys[0];
+		for(int i = 1; i < 12; i++)
+			if(m > (values[i] ^ keys[i]))
+				m = values[i] ^ keys[i];
+		return m;
+#endif
+	}
+	void update(const hash_t * keys){
+#ifdef __AVX2__
+		for(int i = 0; i < 12; i += 4)
+			_mm256_storeu_si256((__m256i *)(values + i), _mm256_xor_si256(load(i), load(keys, i)));
+#else
+		for(int i = 0; i < 12; i++)
+			values[i] ^= keys[i];
+#endif
+	}
+
 	hash_t get() const {
+#ifdef __AVX2__
+		return min12(flip(load(0)), flip(load(4)), flip(load(8)));
+#else
 		hash_t m = values[0];
 		for(int i = 1; i < 12; i++)
 			if(m > values[i])
 				m = values[i];
 		return m;
+#endif
 	}
 };
 